@@ -0,0 +1,101 @@
+// Замер пропускной способности ядра релаксации min-plus (graph::min_plus::RelaxRow)
+//
+// Сборка из корня репозитория:
+//   g++ -std=c++17 -O2 -I source benchmark/min_plus_benchmark.cpp source/min_plus_kernel.cpp -o min_plus_benchmark
+// Запуск: ./min_plus_benchmark [число вершин, по умолчанию 1024]
+//
+// Выполняется полный проход Флойда-Уоршелла по случайной матрице весов ядром, выбранным по возможностям
+// процессора, и скалярным ядром; результаты сравниваются. Пропускная способность считается по двум операциям
+// (сложение и сравнение) на элемент строки, то есть 2 * n^3 операций на проход
+
+#include "min_plus_kernel.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+	using graph::min_plus::PrevEdgeId;
+
+	/// @brief таблица путей: веса и последние рёбра, строки подряд
+	struct RoutesTable {
+		std::vector<double> weights;
+		std::vector<PrevEdgeId> prev_edges;
+	};
+
+	/// @brief Случайный граф с заданной долей рёбер
+	RoutesTable MakeTable(size_t vertex_count) {
+		constexpr double EDGE_PROBABILITY = 0.05;
+		std::mt19937 generator(42);
+		std::uniform_real_distribution<double> weight(1.0, 100.0);
+		std::bernoulli_distribution has_edge(EDGE_PROBABILITY);
+		RoutesTable table{ std::vector<double>(vertex_count * vertex_count, std::numeric_limits<double>::infinity()),
+			std::vector<PrevEdgeId>(vertex_count * vertex_count, graph::min_plus::NO_ROUTE) };
+		PrevEdgeId edge_id = 0;
+		for (size_t from = 0; from < vertex_count; ++from) {
+			for (size_t to = 0; to < vertex_count; ++to) {
+				const size_t index = from * vertex_count + to;
+				if (from == to) {
+					table.weights[index] = 0.0;
+					table.prev_edges[index] = graph::min_plus::NO_EDGE;
+				}
+				else if (has_edge(generator)) {
+					table.weights[index] = weight(generator);
+					table.prev_edges[index] = edge_id++;
+				}
+			}
+		}
+		return table;
+	}
+
+	/// @brief Проход Флойда-Уоршелла заданным ядром
+	/// @return время прохода, с
+	template <typename RelaxRow>
+	double RunFloydWarshall(RoutesTable& table, size_t vertex_count, RelaxRow relax_row) {
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t through = 0; through < vertex_count; ++through) {
+			const double* weights_through = &table.weights[through * vertex_count];
+			const PrevEdgeId* prev_edges_through = &table.prev_edges[through * vertex_count];
+			for (size_t from = 0; from < vertex_count; ++from) {
+				const double weight_from = table.weights[from * vertex_count + through];
+				if (from == through || weight_from == std::numeric_limits<double>::infinity()) {
+					continue;
+				}
+				relax_row(&table.weights[from * vertex_count], &table.prev_edges[from * vertex_count],
+					weights_through, prev_edges_through, weight_from,
+					table.prev_edges[from * vertex_count + through], vertex_count);
+			}
+		}
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+	const size_t vertex_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+	if (vertex_count == 0) {
+		std::cerr << "usage: min_plus_benchmark [vertex_count > 0]\n";
+		return 1;
+	}
+	const RoutesTable source = MakeTable(vertex_count);
+	const double operations = 2.0 * vertex_count * vertex_count * vertex_count;
+
+	RoutesTable scalar_table = source;
+	const double scalar_time = RunFloydWarshall(scalar_table, vertex_count, graph::min_plus::RelaxRowScalar);
+	RoutesTable dispatched_table = source;
+	const double dispatched_time = RunFloydWarshall(dispatched_table, vertex_count, graph::min_plus::RelaxRow);
+
+	const bool same = scalar_table.weights == dispatched_table.weights
+		&& scalar_table.prev_edges == dispatched_table.prev_edges;
+	std::cout << std::fixed << std::setprecision(3)
+		<< "vertices:        " << vertex_count << '\n'
+		<< "instruction set: " << graph::min_plus::GetInstructionSetName(graph::min_plus::GetInstructionSet()) << '\n'
+		<< "scalar:          " << scalar_time << " s, " << operations / scalar_time / 1e9 << " GFLOP/s\n"
+		<< "dispatched:      " << dispatched_time << " s, " << operations / dispatched_time / 1e9 << " GFLOP/s\n"
+		<< "speedup:         " << scalar_time / dispatched_time << '\n'
+		<< "results match:   " << (same ? "yes" : "NO") << '\n';
+	return same ? 0 : 1;
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+	/// @brief Маршрутизатор, ищущий путь по запросу целенаправленным поиском A* (однонаправленным или двунаправленным)
+	/// @details Нижняя оценка LowerBound - функтор Weight(VertexId from, VertexId to), оценивающий снизу
+	/// вес кратчайшего пути между вершинами. Оценка должна удовлетворять неравенству треугольника
+	/// (lower_bound(u, t) <= w(u, v) + lower_bound(v, t) для каждого ребра u->v, и так же для поиска
+	/// от начальной вершины) и быть нулевой для пары одинаковых вершин - тогда каждая вершина
+	/// просматривается не более одного раза, а найденный путь кратчайший.
+	/// Двунаправленный поиск использует усреднённые потенциалы (h_to(v) - h_from(v)) / 2,
+	/// согласованные для обоих направлений
+	template <typename Weight, typename LowerBound>
+	class AStarRouter : public RouterBase<Weight> {
+	private:
+		using Graph = DirectedWeightedGraph<Weight>;
+
+	public:
+		using typename RouterBase<Weight>::RouteInfo;
+
+		/// @param graph замороженный граф с неотрицательными весами рёбер
+		/// @param lower_bound нижняя оценка веса пути между вершинами
+		/// @param bidirectional искать путь одновременно от начала и от конца
+		AStarRouter(const Graph& graph, LowerBound lower_bound, bool bidirectional = false);
+
+		std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+		SearchStats GetSearchStats() const override;
+
+	private:
+		static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+		// элемент очереди с приоритетом: ключ (расстояние с потенциалом) и вершина
+		using QueueItem = std::pair<Weight, VertexId>;
+
+		struct QueueItemGreater {
+			bool operator()(const QueueItem& lhs, const QueueItem& rhs) const {
+				return rhs.first < lhs.first;
+			}
+		};
+
+		using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, QueueItemGreater>;
+
+		/// @brief состояние поиска в одном направлении
+		struct SearchState {
+			explicit SearchState(size_t vertex_count)
+				: weights(vertex_count)
+				, tree_edges(vertex_count, NO_EDGE)
+				, settled(vertex_count, false) {
+			}
+
+			// найденные расстояния от начала поиска
+			std::vector<std::optional<Weight>> weights;
+			// рёбра дерева поиска, по которым достигнуты вершины
+			std::vector<EdgeId> tree_edges;
+			std::vector<bool> settled;
+			Queue queue;
+
+			/// @brief Удаление из очереди устаревших записей об уже просмотренных вершинах
+			void DropSettled() {
+				while (!queue.empty() && settled[queue.top().second]) {
+					queue.pop();
+				}
+			}
+		};
+
+		std::optional<RouteInfo> BuildRouteForward(VertexId from, VertexId to) const;
+		std::optional<RouteInfo> BuildRouteBidirectional(VertexId from, VertexId to) const;
+
+		/// @brief Просмотр очередной вершины в двунаправленном поиске
+		/// @param state состояние поиска в данном направлении
+		/// @param opposite состояние поиска во встречном направлении
+		/// @param forward направление: по рёбрам (true) или против рёбер (false)
+		/// @param potential потенциал вершины для данного направления
+		/// @param best_weight вес лучшего найденного пути (обновляется)
+		/// @param meeting_vertex вершина встречи на лучшем найденном пути (обновляется)
+		template <typename Potential>
+		void SettleNext(SearchState& state, const SearchState& opposite, bool forward, const Potential& potential,
+			std::optional<Weight>& best_weight, VertexId& meeting_vertex) const;
+
+		/// @brief Сборка результата по рёбрам пути; вес суммируется в порядке пути, как при поиске Дейкстрой
+		RouteInfo MakeRouteInfo(std::vector<EdgeId> edges) const;
+
+		void CheckVertex(VertexId vertex) const {
+			if (vertex >= graph_.GetVertexCount()) {
+				throw std::out_of_range("Vertex id is out of range");
+			}
+		}
+
+		static constexpr Weight ZERO_WEIGHT{};
+		const Graph& graph_;
+		LowerBound lower_bound_;
+		bool bidirectional_;
+		// входящие рёбра в CSR-представлении (для обратного поиска): рёбра вершины v занимают
+		// [incoming_offsets_[v], incoming_offsets_[v + 1]); дуга хранит начало ребра и его вес
+		std::vector<size_t> incoming_offsets_;
+		std::vector<EdgeId> incoming_edges_;
+		std::vector<Arc<Weight>> incoming_arcs_;
+		// счётчики для статистики поисков
+		mutable std::atomic<size_t> query_count_{ 0 };
+		mutable std::atomic<size_t> settled_count_{ 0 };
+	};
+
+	template <typename Weight, typename LowerBound>
+	AStarRouter<Weight, LowerBound>::AStarRouter(const Graph& graph, LowerBound lower_bound, bool bidirectional)
+		: graph_(graph)
+		, lower_bound_(std::move(lower_bound))
+		, bidirectional_(bidirectional)
+	{
+		if (!graph.IsFrozen()) {
+			throw std::logic_error("Graph should be frozen before routing");
+		}
+		const size_t vertex_count = graph.GetVertexCount();
+		const size_t edge_count = graph.GetEdgeCount();
+		for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+			if (graph.GetArc(edge_id).weight < ZERO_WEIGHT) {
+				throw std::domain_error("Edges' weights should be non-negative");
+			}
+		}
+		if (!bidirectional_) {
+			return;
+		}
+		// сортировка рёбер подсчётом по вершине конца
+		incoming_offsets_.assign(vertex_count + 1, 0);
+		for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+			++incoming_offsets_[graph.GetArc(edge_id).to + 1];
+		}
+		for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+			incoming_offsets_[vertex + 1] += incoming_offsets_[vertex];
+		}
+		incoming_edges_.resize(edge_count);
+		incoming_arcs_.resize(edge_count);
+		std::vector<size_t> positions(incoming_offsets_.begin(), std::prev(incoming_offsets_.end()));
+		for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+			const auto& edge = graph.GetEdge(edge_id);
+			const size_t position = positions[edge.to]++;
+			incoming_edges_[position] = edge_id;
+			incoming_arcs_[position] = { edge.from, edge.weight };
+		}
+	}
+
+	template <typename Weight, typename LowerBound>
+	std::optional<typename AStarRouter<Weight, LowerBound>::RouteInfo> AStarRouter<Weight, LowerBound>::BuildRoute(
+		VertexId from, VertexId to) const {
+		CheckVertex(from);
+		CheckVertex(to);
+		return bidirectional_ ? BuildRouteBidirectional(from, to) : BuildRouteForward(from, to);
+	}
+
+	template <typename Weight, typename LowerBound>
+	std::optional<typename AStarRouter<Weight, LowerBound>::RouteInfo> AStarRouter<Weight, LowerBound>::BuildRouteForward(
+		VertexId from, VertexId to) const {
+		SearchState state(graph_.GetVertexCount());
+		size_t settled_count = 0;
+
+		state.weights[from] = ZERO_WEIGHT;
+		state.queue.push({ lower_bound_(from, to), from });
+		while (!state.queue.empty()) {
+			const VertexId vertex = state.queue.top().second;
+			state.queue.pop();
+			// устаревшая запись: вершина уже просмотрена
+			if (state.settled[vertex]) {
+				continue;
+			}
+			state.settled[vertex] = true;
+			++settled_count;
+			if (vertex == to) {
+				break;
+			}
+			const Weight weight = *state.weights[vertex];
+			for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+				const auto& edge = graph_.GetArc(edge_id);
+				const Weight candidate_weight = weight + edge.weight;
+				auto& weight_to = state.weights[edge.to];
+				if (!weight_to || candidate_weight < *weight_to) {
+					weight_to = candidate_weight;
+					state.tree_edges[edge.to] = edge_id;
+					state.queue.push({ candidate_weight + lower_bound_(edge.to, to), edge.to });
+				}
+			}
+		}
+		++query_count_;
+		settled_count_ += settled_count;
+
+		if (!state.weights[to]) {
+			return std::nullopt;
+		}
+		std::vector<EdgeId> edges;
+		for (VertexId vertex = to; state.tree_edges[vertex] != NO_EDGE; vertex = graph_.GetEdge(state.tree_edges[vertex]).from) {
+			edges.push_back(state.tree_edges[vertex]);
+		}
+		std::reverse(edges.begin(), edges.end());
+		return MakeRouteInfo(std::move(edges));
+	}
+
+	template <typename Weight, typename LowerBound>
+	template <typename Potential>
+	void AStarRouter<Weight, LowerBound>::SettleNext(SearchState& state, const SearchState& opposite, bool forward,
+		const Potential& potential, std::optional<Weight>& best_weight, VertexId& meeting_vertex) const {
+		const VertexId vertex = state.queue.top().second;
+		state.queue.pop();
+		state.settled[vertex] = true;
+		const Weight weight = *state.weights[vertex];
+
+		auto relax = [&](EdgeId edge_id, const Arc<Weight>& arc) {
+			const Weight candidate_weight = weight + arc.weight;
+			auto& weight_next = state.weights[arc.to];
+			if (!weight_next || candidate_weight < *weight_next) {
+				weight_next = candidate_weight;
+				state.tree_edges[arc.to] = edge_id;
+				state.queue.push({ candidate_weight + potential(arc.to), arc.to });
+			}
+			// путь через вершину, уже достигнутую встречным поиском
+			if (opposite.weights[arc.to]) {
+				const Weight path_weight = *weight_next + *opposite.weights[arc.to];
+				if (!best_weight || path_weight < *best_weight) {
+					best_weight = path_weight;
+					meeting_vertex = arc.to;
+				}
+			}
+		};
+
+		if (forward) {
+			for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+				relax(edge_id, graph_.GetArc(edge_id));
+			}
+		}
+		else {
+			for (size_t position = incoming_offsets_[vertex]; position < incoming_offsets_[vertex + 1]; ++position) {
+				relax(incoming_edges_[position], incoming_arcs_[position]);
+			}
+		}
+	}
+
+	template <typename Weight, typename LowerBound>
+	std::optional<typename AStarRouter<Weight, LowerBound>::RouteInfo>
+		AStarRouter<Weight, LowerBound>::BuildRouteBidirectional(VertexId from, VertexId to) const {
+		const size_t vertex_count = graph_.GetVertexCount();
+		// потенциал прямого поиска; у обратного поиска он с обратным знаком
+		auto forward_potential = [this, from, to](VertexId vertex) {
+			return (lower_bound_(vertex, to) - lower_bound_(from, vertex)) / 2;
+		};
+		auto backward_potential = [&forward_potential](VertexId vertex) {
+			return -forward_potential(vertex);
+		};
+		SearchState forward_state(vertex_count);
+		SearchState backward_state(vertex_count);
+		forward_state.weights[from] = ZERO_WEIGHT;
+		forward_state.queue.push({ forward_potential(from), from });
+		backward_state.weights[to] = ZERO_WEIGHT;
+		backward_state.queue.push({ backward_potential(to), to });
+
+		std::optional<Weight> best_weight;
+		VertexId meeting_vertex = from;
+		if (from == to) {
+			best_weight = ZERO_WEIGHT;
+		}
+		size_t settled_count = 0;
+		while (true) {
+			forward_state.DropSettled();
+			backward_state.DropSettled();
+			if (forward_state.queue.empty() || backward_state.queue.empty()) {
+				break;
+			}
+			// сумма ключей не превосходит веса любого ещё не найденного пути
+			const Weight forward_key = forward_state.queue.top().first;
+			const Weight backward_key = backward_state.queue.top().first;
+			if (best_weight && !(forward_key + backward_key < *best_weight)) {
+				break;
+			}
+			++settled_count;
+			if (!(backward_key < forward_key)) {
+				SettleNext(forward_state, backward_state, true, forward_potential, best_weight, meeting_vertex);
+			}
+			else {
+				SettleNext(backward_state, forward_state, false, backward_potential, best_weight, meeting_vertex);
+			}
+		}
+		++query_count_;
+		settled_count_ += settled_count;
+
+		if (!best_weight) {
+			return std::nullopt;
+		}
+		// рёбра от начала до точки встречи и от точки встречи до конца
+		std::vector<EdgeId> edges;
+		for (VertexId vertex = meeting_vertex; forward_state.tree_edges[vertex] != NO_EDGE;
+			vertex = graph_.GetEdge(forward_state.tree_edges[vertex]).from) {
+			edges.push_back(forward_state.tree_edges[vertex]);
+		}
+		std::reverse(edges.begin(), edges.end());
+		for (VertexId vertex = meeting_vertex; backward_state.tree_edges[vertex] != NO_EDGE;
+			vertex = graph_.GetEdge(backward_state.tree_edges[vertex]).to) {
+			edges.push_back(backward_state.tree_edges[vertex]);
+		}
+		return MakeRouteInfo(std::move(edges));
+	}
+
+	template <typename Weight, typename LowerBound>
+	typename AStarRouter<Weight, LowerBound>::RouteInfo AStarRouter<Weight, LowerBound>::MakeRouteInfo(
+		std::vector<EdgeId> edges) const {
+		Weight weight = ZERO_WEIGHT;
+		for (const EdgeId edge_id : edges) {
+			weight = weight + graph_.GetArc(edge_id).weight;
+		}
+		return RouteInfo{ weight, std::move(edges) };
+	}
+
+	template <typename Weight, typename LowerBound>
+	SearchStats AStarRouter<Weight, LowerBound>::GetSearchStats() const {
+		return { query_count_.load(), settled_count_.load() };
+	}
+}  // namespace graph
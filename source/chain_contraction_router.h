@@ -0,0 +1,522 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace graph {
+	/// @brief Маршрутизатор, сжимающий проходные вершины графа в составные рёбра
+	/// @details Сжимаются два вида вершин:
+	/// - висячие: все рёбра ведут к одной соседней вершине («хозяину»), например остановка, через которую
+	///   проходит одна позиция одного маршрута;
+	/// - цепочечные: после удаления висячих вершин у вершины ровно одно входящее и одно исходящее ребро
+	///   от разных соседей, например позиция маршрута между такими остановками.
+	/// Цепочка таких вершин между двумя вершинами ядра заменяется одним ребром с суммарным весом, и движок
+	/// строится только по графу ядра. Запрос из сжатой вершины (или в неё) отвечается присоединением её
+	/// к концам цепочки: из цепочечной вершины можно выйти только в конец цепочки, войти - только из начала
+	template <typename Weight>
+	class ChainContractionRouter : public RouterBase<Weight> {
+	private:
+		using Graph = DirectedWeightedGraph<Weight>;
+
+	public:
+		using typename RouterBase<Weight>::RouteInfo;
+
+		/// @brief Построение движка по графу ядра
+		/// @details Аргументы: замороженный граф ядра и id его вершин в исходном графе
+		/// (vertices[id в ядре] = исходный id)
+		using RouterFactory = std::function<std::unique_ptr<RouterBase<Weight>>(const Graph& graph,
+			const std::vector<VertexId>& vertices)>;
+
+		/// @param graph замороженный граф
+		/// @param router_factory построение движка ядра (вызывается один раз в конструкторе)
+		ChainContractionRouter(const Graph& graph, const RouterFactory& router_factory);
+
+		std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+		std::optional<Weight> BuildRouteWeight(VertexId from, VertexId to) const override;
+
+		/// @brief Веса считаются одной матрицей движка ядра между концами цепочек источников и целей
+		std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+			const std::vector<VertexId>& targets) const override;
+
+		/// @brief Статистика движка ядра
+		SearchStats GetSearchStats() const override;
+
+		/// @brief Число вершин графа ядра, по которому построен движок
+		size_t GetCoreVertexCount() const;
+
+	private:
+		/// @brief цепочка сжатых вершин между вершинами ядра
+		struct Chain {
+			VertexId from;
+			VertexId to;
+			// рёбра цепочки по порядку: ребро edges[k] выходит из вершины цепочки в позиции k
+			// (позиция 0 - начало цепочки)
+			std::vector<EdgeId> edges;
+			// prefix_weights[k] - вес пути от начала цепочки до вершины в позиции k
+			std::vector<Weight> prefix_weights;
+		};
+
+		/// @brief ребро графа ядра: ребро исходного графа или цепочка
+		struct CoreEdge {
+			EdgeId edge;
+			size_t chain;
+		};
+
+		/// @brief выход сжатой вершины в ядро (или вход из ядра): вершина ядра и вес пути между ними
+		struct Attachment {
+			VertexId core;
+			Weight weight;
+		};
+
+		void CheckVertex(VertexId vertex) const {
+			if (vertex >= graph_.GetVertexCount()) {
+				throw std::out_of_range("Vertex id is out of range");
+			}
+		}
+
+		bool IsLeaf(VertexId vertex) const {
+			return anchors_[vertex] != vertex;
+		}
+
+		/// @brief Из вершины есть путь хотя бы в одну другую вершину (у висячей вершины - ребро к хозяину)
+		bool CanLeave(VertexId vertex) const {
+			return !IsLeaf(vertex) || leaf_out_edges_[vertex] != NO_EDGE;
+		}
+
+		/// @brief В вершину есть путь хотя бы из одной другой вершины
+		bool CanEnter(VertexId vertex) const {
+			return !IsLeaf(vertex) || leaf_in_edges_[vertex] != NO_EDGE;
+		}
+
+		/// @brief Путь между различными вершинами from и to не проходит через ядро: их хозяева совпадают
+		/// или лежат на одной цепочке в порядке следования
+		bool IsDirect(VertexId from, VertexId to) const;
+
+		/// @brief Выход из вершины в ядро (вершина должна удовлетворять CanLeave)
+		Attachment GetExit(VertexId vertex) const;
+
+		/// @brief Вход в вершину из ядра (вершина должна удовлетворять CanEnter)
+		Attachment GetEntry(VertexId vertex) const;
+
+		/// @brief Вес пути между вершинами, связанными напрямую (см. IsDirect)
+		Weight GetDirectWeight(VertexId from, VertexId to) const;
+
+		/// @brief Добавление рёбер цепочки с позиции begin до позиции end
+		void AppendChainEdges(const Chain& chain, size_t begin, size_t end, std::vector<EdgeId>& edges) const;
+
+		/// @brief Добавление рёбер пути, не выходящего из цепочки, между хозяевами вершин
+		void AppendDirectEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const;
+
+		void AppendExitEdges(VertexId vertex, std::vector<EdgeId>& edges) const;
+
+		void AppendEntryEdges(VertexId vertex, std::vector<EdgeId>& edges) const;
+
+		static constexpr VertexId NO_VERTEX = static_cast<VertexId>(-1);
+		static constexpr EdgeId NO_EDGE = static_cast<EdgeId>(-1);
+		static constexpr size_t NO_CHAIN = static_cast<size_t>(-1);
+		static constexpr Weight ZERO_WEIGHT{};
+		const Graph& graph_;
+		// хозяин висячей вершины; у остальных вершин - она сама
+		std::vector<VertexId> anchors_;
+		// ребро висячей вершины к хозяину и от него (наименьшего веса); NO_EDGE, если такого нет
+		std::vector<EdgeId> leaf_out_edges_;
+		std::vector<EdgeId> leaf_in_edges_;
+		// цепочка вершины и позиция в ней; NO_CHAIN у вершин ядра и висячих вершин
+		std::vector<size_t> chain_ids_;
+		std::vector<size_t> chain_positions_;
+		std::vector<Chain> chains_;
+		// id вершины в ядре; NO_VERTEX у сжатых вершин
+		std::vector<VertexId> core_ids_;
+		// исходные id вершин ядра
+		std::vector<VertexId> core_vertices_;
+		Graph core_graph_;
+		// рёбра ядра, индексированные id ребра в замороженном графе ядра
+		std::vector<CoreEdge> core_edges_;
+		std::unique_ptr<RouterBase<Weight>> core_router_;
+	};
+
+	template <typename Weight>
+	ChainContractionRouter<Weight>::ChainContractionRouter(const Graph& graph, const RouterFactory& router_factory)
+		: graph_(graph)
+	{
+		if (!graph.IsFrozen()) {
+			throw std::logic_error("Graph should be frozen before routing");
+		}
+		const size_t vertex_count = graph.GetVertexCount();
+		const size_t edge_count = graph.GetEdgeCount();
+
+		// висячие вершины: единственный сосед, отличный от самой вершины; из двух висячих друг для друга
+		// вершин сжимается большая, поэтому хозяин никогда не бывает висячим
+		std::vector<VertexId> neighbours(vertex_count, NO_VERTEX);
+		std::vector<bool> has_many_neighbours(vertex_count, false);
+		auto add_neighbour = [&neighbours, &has_many_neighbours](VertexId vertex, VertexId neighbour) {
+			if (neighbour == vertex || (neighbours[vertex] != NO_VERTEX && neighbours[vertex] != neighbour)) {
+				has_many_neighbours[vertex] = true;
+			}
+			neighbours[vertex] = neighbour;
+		};
+		for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+			const auto& edge = graph.GetEdge(edge_id);
+			add_neighbour(edge.from, edge.to);
+			add_neighbour(edge.to, edge.from);
+		}
+		auto has_single_neighbour = [&neighbours, &has_many_neighbours](VertexId vertex) {
+			return !has_many_neighbours[vertex] && neighbours[vertex] != NO_VERTEX;
+		};
+		anchors_.resize(vertex_count);
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			anchors_[vertex] = vertex;
+			if (!has_single_neighbour(vertex)) {
+				continue;
+			}
+			const VertexId neighbour = neighbours[vertex];
+			if (!has_single_neighbour(neighbour) || neighbours[neighbour] != vertex || neighbour < vertex) {
+				anchors_[vertex] = neighbour;
+			}
+		}
+		leaf_out_edges_.assign(vertex_count, NO_EDGE);
+		leaf_in_edges_.assign(vertex_count, NO_EDGE);
+		auto keep_lighter = [this](EdgeId& current, EdgeId edge_id) {
+			if (current == NO_EDGE || graph_.GetEdge(edge_id).weight < graph_.GetEdge(current).weight) {
+				current = edge_id;
+			}
+		};
+
+		// степени вершин без рёбер висячих вершин
+		std::vector<size_t> in_degrees(vertex_count, 0);
+		std::vector<size_t> out_degrees(vertex_count, 0);
+		std::vector<EdgeId> next_edges(vertex_count, NO_EDGE);
+		std::vector<EdgeId> prev_edges(vertex_count, NO_EDGE);
+		for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+			const auto& edge = graph.GetEdge(edge_id);
+			if (IsLeaf(edge.from)) {
+				keep_lighter(leaf_out_edges_[edge.from], edge_id);
+				continue;
+			}
+			if (IsLeaf(edge.to)) {
+				keep_lighter(leaf_in_edges_[edge.to], edge_id);
+				continue;
+			}
+			++out_degrees[edge.from];
+			++in_degrees[edge.to];
+			next_edges[edge.from] = edge_id;
+			prev_edges[edge.to] = edge_id;
+		}
+		std::vector<bool> in_chain(vertex_count, false);
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			if (IsLeaf(vertex) || in_degrees[vertex] != 1 || out_degrees[vertex] != 1) {
+				continue;
+			}
+			const VertexId prev = graph.GetEdge(prev_edges[vertex]).from;
+			const VertexId next = graph.GetEdge(next_edges[vertex]).to;
+			in_chain[vertex] = prev != vertex && next != vertex && prev != next;
+		}
+
+		// цепочки, не начинающиеся в ядре, замкнуты в цикл: одна вершина цикла переводится в ядро
+		std::vector<bool> visited(vertex_count, false);
+		auto visit_chain = [&graph, &next_edges, &in_chain, &visited](VertexId vertex) {
+			while (in_chain[vertex] && !visited[vertex]) {
+				visited[vertex] = true;
+				vertex = graph.GetEdge(next_edges[vertex]).to;
+			}
+		};
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			if (!IsLeaf(vertex) && !in_chain[vertex]) {
+				for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+					visit_chain(graph.GetEdge(edge_id).to);
+				}
+			}
+		}
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			if (in_chain[vertex] && !visited[vertex]) {
+				in_chain[vertex] = false;
+				visit_chain(graph.GetEdge(next_edges[vertex]).to);
+			}
+		}
+
+		core_ids_.assign(vertex_count, NO_VERTEX);
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			if (!IsLeaf(vertex) && !in_chain[vertex]) {
+				core_ids_[vertex] = core_vertices_.size();
+				core_vertices_.push_back(vertex);
+			}
+		}
+
+		// граф ядра: рёбра между вершинами ядра и цепочки; петли путей не сокращают и не добавляются
+		core_graph_ = Graph(core_vertices_.size());
+		chain_ids_.assign(vertex_count, NO_CHAIN);
+		chain_positions_.assign(vertex_count, 0);
+		std::vector<CoreEdge> added_edges;
+		for (const VertexId from : core_vertices_) {
+			for (const EdgeId edge_id : graph.GetIncidentEdges(from)) {
+				const auto& edge = graph.GetEdge(edge_id);
+				if (IsLeaf(edge.to)) {
+					continue;
+				}
+				if (!in_chain[edge.to]) {
+					if (edge.to != from) {
+						core_graph_.AddEdge({ core_ids_[from], core_ids_[edge.to], edge.weight });
+						added_edges.push_back({ edge_id, NO_CHAIN });
+					}
+					continue;
+				}
+				Chain chain{ from, edge.to, { edge_id }, { ZERO_WEIGHT, edge.weight } };
+				while (in_chain[chain.to]) {
+					chain_ids_[chain.to] = chains_.size();
+					chain_positions_[chain.to] = chain.edges.size();
+					const EdgeId next_edge = next_edges[chain.to];
+					chain.edges.push_back(next_edge);
+					chain.prefix_weights.push_back(chain.prefix_weights.back() + graph.GetEdge(next_edge).weight);
+					chain.to = graph.GetEdge(next_edge).to;
+				}
+				if (chain.to != from) {
+					core_graph_.AddEdge({ core_ids_[from], core_ids_[chain.to], chain.prefix_weights.back() });
+					added_edges.push_back({ NO_EDGE, chains_.size() });
+				}
+				chains_.push_back(std::move(chain));
+			}
+		}
+		const auto new_edge_ids = core_graph_.Freeze();
+		core_edges_.resize(added_edges.size());
+		for (EdgeId edge_id = 0; edge_id < added_edges.size(); ++edge_id) {
+			core_edges_[new_edge_ids[edge_id]] = added_edges[edge_id];
+		}
+		core_router_ = router_factory(core_graph_, core_vertices_);
+	}
+
+	template <typename Weight>
+	bool ChainContractionRouter<Weight>::IsDirect(VertexId from, VertexId to) const {
+		const VertexId from_anchor = anchors_[from];
+		const VertexId to_anchor = anchors_[to];
+		if (from_anchor == to_anchor) {
+			return true;
+		}
+		const size_t chain_id = chain_ids_[from_anchor];
+		return chain_id != NO_CHAIN && chain_id == chain_ids_[to_anchor]
+			&& chain_positions_[from_anchor] < chain_positions_[to_anchor];
+	}
+
+	template <typename Weight>
+	typename ChainContractionRouter<Weight>::Attachment ChainContractionRouter<Weight>::GetExit(VertexId vertex) const {
+		Weight weight = ZERO_WEIGHT;
+		if (IsLeaf(vertex)) {
+			weight += graph_.GetEdge(leaf_out_edges_[vertex]).weight;
+			vertex = anchors_[vertex];
+		}
+		if (const size_t chain_id = chain_ids_[vertex]; chain_id != NO_CHAIN) {
+			const auto& chain = chains_[chain_id];
+			weight += chain.prefix_weights.back() - chain.prefix_weights[chain_positions_[vertex]];
+			vertex = chain.to;
+		}
+		return { core_ids_[vertex], weight };
+	}
+
+	template <typename Weight>
+	typename ChainContractionRouter<Weight>::Attachment ChainContractionRouter<Weight>::GetEntry(VertexId vertex) const {
+		Weight weight = ZERO_WEIGHT;
+		if (IsLeaf(vertex)) {
+			weight += graph_.GetEdge(leaf_in_edges_[vertex]).weight;
+			vertex = anchors_[vertex];
+		}
+		if (const size_t chain_id = chain_ids_[vertex]; chain_id != NO_CHAIN) {
+			const auto& chain = chains_[chain_id];
+			weight += chain.prefix_weights[chain_positions_[vertex]];
+			vertex = chain.from;
+		}
+		return { core_ids_[vertex], weight };
+	}
+
+	template <typename Weight>
+	Weight ChainContractionRouter<Weight>::GetDirectWeight(VertexId from, VertexId to) const {
+		Weight weight = ZERO_WEIGHT;
+		if (IsLeaf(from)) {
+			weight += graph_.GetEdge(leaf_out_edges_[from]).weight;
+		}
+		const VertexId from_anchor = anchors_[from];
+		const VertexId to_anchor = anchors_[to];
+		if (from_anchor != to_anchor) {
+			const auto& chain = chains_[chain_ids_[from_anchor]];
+			weight += chain.prefix_weights[chain_positions_[to_anchor]] - chain.prefix_weights[chain_positions_[from_anchor]];
+		}
+		if (IsLeaf(to)) {
+			weight += graph_.GetEdge(leaf_in_edges_[to]).weight;
+		}
+		return weight;
+	}
+
+	template <typename Weight>
+	void ChainContractionRouter<Weight>::AppendChainEdges(const Chain& chain, size_t begin, size_t end,
+		std::vector<EdgeId>& edges) const {
+		edges.insert(edges.end(), chain.edges.begin() + begin, chain.edges.begin() + end);
+	}
+
+	template <typename Weight>
+	void ChainContractionRouter<Weight>::AppendDirectEdges(VertexId from, VertexId to, std::vector<EdgeId>& edges) const {
+		if (from != to) {
+			AppendChainEdges(chains_[chain_ids_[from]], chain_positions_[from], chain_positions_[to], edges);
+		}
+	}
+
+	template <typename Weight>
+	void ChainContractionRouter<Weight>::AppendExitEdges(VertexId vertex, std::vector<EdgeId>& edges) const {
+		if (IsLeaf(vertex)) {
+			edges.push_back(leaf_out_edges_[vertex]);
+			vertex = anchors_[vertex];
+		}
+		if (const size_t chain_id = chain_ids_[vertex]; chain_id != NO_CHAIN) {
+			const auto& chain = chains_[chain_id];
+			AppendChainEdges(chain, chain_positions_[vertex], chain.edges.size(), edges);
+		}
+	}
+
+	template <typename Weight>
+	void ChainContractionRouter<Weight>::AppendEntryEdges(VertexId vertex, std::vector<EdgeId>& edges) const {
+		const VertexId anchor = anchors_[vertex];
+		if (const size_t chain_id = chain_ids_[anchor]; chain_id != NO_CHAIN) {
+			AppendChainEdges(chains_[chain_id], 0, chain_positions_[anchor], edges);
+		}
+		if (IsLeaf(vertex)) {
+			edges.push_back(leaf_in_edges_[vertex]);
+		}
+	}
+
+	template <typename Weight>
+	std::optional<typename ChainContractionRouter<Weight>::RouteInfo> ChainContractionRouter<Weight>::BuildRoute(
+		VertexId from, VertexId to) const {
+		CheckVertex(from);
+		CheckVertex(to);
+		if (from == to) {
+			return RouteInfo{ ZERO_WEIGHT, {} };
+		}
+		if (!CanLeave(from) || !CanEnter(to)) {
+			return std::nullopt;
+		}
+		RouteInfo route{ ZERO_WEIGHT, {} };
+		if (IsDirect(from, to)) {
+			if (IsLeaf(from)) {
+				route.edges.push_back(leaf_out_edges_[from]);
+			}
+			AppendDirectEdges(anchors_[from], anchors_[to], route.edges);
+			if (IsLeaf(to)) {
+				route.edges.push_back(leaf_in_edges_[to]);
+			}
+		}
+		else {
+			const auto core_route = core_router_->BuildRoute(GetExit(from).core, GetEntry(to).core);
+			if (!core_route) {
+				return std::nullopt;
+			}
+			AppendExitEdges(from, route.edges);
+			for (const EdgeId core_edge_id : core_route->edges) {
+				const auto& core_edge = core_edges_[core_edge_id];
+				if (core_edge.chain == NO_CHAIN) {
+					route.edges.push_back(core_edge.edge);
+				}
+				else {
+					const auto& chain = chains_[core_edge.chain];
+					AppendChainEdges(chain, 0, chain.edges.size(), route.edges);
+				}
+			}
+			AppendEntryEdges(to, route.edges);
+		}
+		// вес суммируется в порядке пути, как у движков без сжатия
+		for (const EdgeId edge_id : route.edges) {
+			route.weight += graph_.GetEdge(edge_id).weight;
+		}
+		return route;
+	}
+
+	template <typename Weight>
+	std::optional<Weight> ChainContractionRouter<Weight>::BuildRouteWeight(VertexId from, VertexId to) const {
+		CheckVertex(from);
+		CheckVertex(to);
+		if (from == to) {
+			return ZERO_WEIGHT;
+		}
+		if (!CanLeave(from) || !CanEnter(to)) {
+			return std::nullopt;
+		}
+		if (IsDirect(from, to)) {
+			return GetDirectWeight(from, to);
+		}
+		const Attachment exit = GetExit(from);
+		const Attachment entry = GetEntry(to);
+		const auto core_weight = core_router_->BuildRouteWeight(exit.core, entry.core);
+		if (!core_weight) {
+			return std::nullopt;
+		}
+		return exit.weight + *core_weight + entry.weight;
+	}
+
+	template <typename Weight>
+	std::vector<std::vector<std::optional<Weight>>> ChainContractionRouter<Weight>::BuildWeightMatrix(
+		const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+		std::vector<std::vector<std::optional<Weight>>> result(sources.size(),
+			std::vector<std::optional<Weight>>(targets.size()));
+		// различные вершины ядра, через которые выходят источники и входят цели, и их позиции в матрице ядра
+		std::vector<VertexId> core_sources;
+		std::vector<VertexId> core_targets;
+		std::unordered_map<VertexId, size_t> core_source_positions;
+		std::unordered_map<VertexId, size_t> core_target_positions;
+		std::vector<std::optional<Attachment>> exits(sources.size());
+		std::vector<std::optional<Attachment>> entries(targets.size());
+		for (size_t i = 0; i < sources.size(); ++i) {
+			CheckVertex(sources[i]);
+			if (CanLeave(sources[i])) {
+				exits[i] = GetExit(sources[i]);
+				if (core_source_positions.emplace(exits[i]->core, core_sources.size()).second) {
+					core_sources.push_back(exits[i]->core);
+				}
+			}
+		}
+		for (size_t j = 0; j < targets.size(); ++j) {
+			CheckVertex(targets[j]);
+			if (CanEnter(targets[j])) {
+				entries[j] = GetEntry(targets[j]);
+				if (core_target_positions.emplace(entries[j]->core, core_targets.size()).second) {
+					core_targets.push_back(entries[j]->core);
+				}
+			}
+		}
+		std::vector<std::vector<std::optional<Weight>>> core_weights;
+		if (!core_sources.empty() && !core_targets.empty()) {
+			core_weights = core_router_->BuildWeightMatrix(core_sources, core_targets);
+		}
+		for (size_t i = 0; i < sources.size(); ++i) {
+			for (size_t j = 0; j < targets.size(); ++j) {
+				if (sources[i] == targets[j]) {
+					result[i][j] = ZERO_WEIGHT;
+				}
+				else if (!exits[i] || !entries[j]) {
+					continue;
+				}
+				else if (IsDirect(sources[i], targets[j])) {
+					result[i][j] = GetDirectWeight(sources[i], targets[j]);
+				}
+				else if (const auto& core_weight = core_weights[core_source_positions.at(exits[i]->core)]
+					[core_target_positions.at(entries[j]->core)]) {
+					result[i][j] = exits[i]->weight + *core_weight + entries[j]->weight;
+				}
+			}
+		}
+		return result;
+	}
+
+	template <typename Weight>
+	SearchStats ChainContractionRouter<Weight>::GetSearchStats() const {
+		return core_router_->GetSearchStats();
+	}
+
+	template <typename Weight>
+	size_t ChainContractionRouter<Weight>::GetCoreVertexCount() const {
+		return core_vertices_.size();
+	}
+}  // namespace graph
@@ -0,0 +1,453 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+	/// @brief Маршрутизатор, разбивающий граф на компоненты слабой связности
+	/// @details Между вершинами разных компонент слабой связности пути нет, поэтому такие запросы
+	/// отвечаются сравнением номеров компонент за O(1). Для каждой компоненты с рёбрами строится
+	/// отдельный подграф и свой движок (например, таблица Флойда-Уоршелла размером с компоненту);
+	/// изолированные вершины движка не требуют. Компоненты сильной связности для этого не подходят:
+	/// путь может вести из одной такой компоненты в другую
+	template <typename Weight>
+	class ComponentRouter : public RouterBase<Weight> {
+	private:
+		using Graph = DirectedWeightedGraph<Weight>;
+
+	public:
+		using typename RouterBase<Weight>::RouteInfo;
+
+		/// @brief Построение движка по графу компоненты
+		/// @details Аргументы: замороженный граф компоненты и id её вершин в исходном графе
+		/// (vertices[локальный id] = исходный id)
+		using RouterFactory = std::function<std::unique_ptr<RouterBase<Weight>>(const Graph& graph,
+			const std::vector<VertexId>& vertices)>;
+
+		/// @param graph замороженный граф
+		/// @param router_factory построение движка компоненты; если компонента одна, движок строится
+		/// по исходному графу без копирования. Фабрика вызывается и в Update для новых и слившихся компонент
+		ComponentRouter(const Graph& graph, RouterFactory router_factory);
+
+		std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+		std::optional<Weight> BuildRouteWeight(VertexId from, VertexId to) const override;
+
+		/// @brief Веса считаются движками компонент только для пар из одной компоненты
+		std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+			const std::vector<VertexId>& targets) const override;
+
+		/// @brief Обновление затрагивает только компоненты, в которые попали новые рёбра
+		/// @details Компоненты слабой связности при добавлении рёбер только растут и сливаются. Компонента,
+		/// в которую вошла ровно одна прежняя компонента с рёбрами, дополняется новыми вершинами и рёбрами, и
+		/// обновление передаётся её движку (при отказе движок строится заново); компоненты без новых рёбер
+		/// остаются как есть; для слившихся и совсем новых компонент движки строятся заново. Если движок
+		/// построен по всему графу, обновление передаётся ему
+		bool Update(const std::vector<EdgeId>& new_edge_ids) override;
+
+		/// @brief Суммарная статистика движков компонент
+		SearchStats GetSearchStats() const override;
+
+		/// @brief Число компонент слабой связности (включая изолированные вершины)
+		size_t GetComponentCount() const;
+
+		/// @brief Движки компонент с рёбрами
+		std::vector<const RouterBase<Weight>*> GetComponentRouters() const;
+
+	private:
+		/// @brief компонента с рёбрами
+		struct Component {
+			// граф компоненты; пуст, если компонента - весь исходный граф
+			std::unique_ptr<Graph> graph;
+			// исходные id вершин, индексированные локальными id
+			std::vector<VertexId> vertices;
+			// исходные id рёбер, индексированные локальными id
+			std::vector<EdgeId> edges;
+			std::unique_ptr<RouterBase<Weight>> router;
+		};
+
+		/// @brief Разметка вершин по компонентам слабой связности (система непересекающихся множеств)
+		void FindComponents();
+
+		/// @brief Построение подграфов и движков компонент
+		void BuildComponents();
+
+		/// @brief Построение подграфов и движков выбранных компонент (у которых ещё нет движка)
+		/// @param selected флаги по номерам компонент
+		void AddComponents(const std::vector<bool>& selected);
+
+		void CheckVertex(VertexId vertex) const {
+			if (vertex >= graph_.GetVertexCount()) {
+				throw std::out_of_range("Vertex id is out of range");
+			}
+		}
+
+		static constexpr size_t NO_COMPONENT = static_cast<size_t>(-1);
+		static constexpr Weight ZERO_WEIGHT{};
+		const Graph& graph_;
+		RouterFactory router_factory_;
+		// число рёбер графа, учтённых в компонентах
+		size_t edge_count_ = 0;
+		size_t component_count_ = 0;
+		// номер компоненты вершины
+		std::vector<size_t> component_ids_;
+		// локальный id вершины в её компоненте
+		std::vector<VertexId> local_ids_;
+		// индекс в components_ для каждой компоненты; NO_COMPONENT у изолированных вершин
+		std::vector<size_t> component_indexes_;
+		std::vector<Component> components_;
+	};
+
+	template <typename Weight>
+	ComponentRouter<Weight>::ComponentRouter(const Graph& graph, RouterFactory router_factory)
+		: graph_(graph)
+		, router_factory_(std::move(router_factory))
+	{
+		if (!graph.IsFrozen()) {
+			throw std::logic_error("Graph should be frozen before routing");
+		}
+		FindComponents();
+		BuildComponents();
+		edge_count_ = graph.GetEdgeCount();
+	}
+
+	template <typename Weight>
+	void ComponentRouter<Weight>::FindComponents() {
+		const size_t vertex_count = graph_.GetVertexCount();
+		std::vector<VertexId> parents(vertex_count);
+		std::iota(parents.begin(), parents.end(), 0);
+		auto find_root = [&parents](VertexId vertex) {
+			while (parents[vertex] != vertex) {
+				parents[vertex] = parents[parents[vertex]];
+				vertex = parents[vertex];
+			}
+			return vertex;
+		};
+		for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+			const auto& edge = graph_.GetEdge(edge_id);
+			const VertexId from_root = find_root(edge.from);
+			const VertexId to_root = find_root(edge.to);
+			if (from_root != to_root) {
+				parents[std::max(from_root, to_root)] = std::min(from_root, to_root);
+			}
+		}
+		// корень множества - его наименьшая вершина, поэтому он нумеруется раньше остальных вершин
+		component_ids_.assign(vertex_count, NO_COMPONENT);
+		component_count_ = 0;
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			const VertexId root = find_root(vertex);
+			if (root == vertex) {
+				component_ids_[vertex] = component_count_++;
+			}
+			else {
+				component_ids_[vertex] = component_ids_[root];
+			}
+		}
+	}
+
+	template <typename Weight>
+	void ComponentRouter<Weight>::BuildComponents() {
+		const size_t vertex_count = graph_.GetVertexCount();
+		component_indexes_.assign(component_count_, NO_COMPONENT);
+		components_.clear();
+		local_ids_.assign(vertex_count, 0);
+
+		// весь граф - одна компонента: движок строится по нему самому
+		if (component_count_ == 1 && graph_.GetEdgeCount() > 0) {
+			auto& component = components_.emplace_back();
+			component.vertices.resize(vertex_count);
+			std::iota(component.vertices.begin(), component.vertices.end(), 0);
+			std::iota(local_ids_.begin(), local_ids_.end(), 0);
+			component.router = router_factory_(graph_, component.vertices);
+			component_indexes_[0] = 0;
+			return;
+		}
+		AddComponents(std::vector<bool>(component_count_, true));
+	}
+
+	template <typename Weight>
+	void ComponentRouter<Weight>::AddComponents(const std::vector<bool>& selected) {
+		const size_t vertex_count = graph_.GetVertexCount();
+		const size_t edge_count = graph_.GetEdgeCount();
+		const size_t first_index = components_.size();
+
+		// компоненты с рёбрами и их вершины (в порядке возрастания исходных id)
+		for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+			const size_t component_id = component_ids_[graph_.GetEdge(edge_id).from];
+			auto& index = component_indexes_[component_id];
+			if (selected[component_id] && index == NO_COMPONENT) {
+				index = components_.size();
+				components_.emplace_back();
+			}
+		}
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			const size_t component_id = component_ids_[vertex];
+			const size_t index = component_indexes_[component_id];
+			if (!selected[component_id] || index == NO_COMPONENT) {
+				continue;
+			}
+			auto& vertices = components_[index].vertices;
+			local_ids_[vertex] = vertices.size();
+			vertices.push_back(vertex);
+		}
+		for (size_t index = first_index; index < components_.size(); ++index) {
+			components_[index].graph = std::make_unique<Graph>(components_[index].vertices.size());
+		}
+		// рёбра замороженного графа упорядочены по начальной вершине, поэтому и в графах компонент
+		// они добавляются упорядоченными
+		std::vector<std::vector<EdgeId>> added_edges(components_.size() - first_index);
+		for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+			const auto& edge = graph_.GetEdge(edge_id);
+			const size_t component_id = component_ids_[edge.from];
+			if (!selected[component_id]) {
+				continue;
+			}
+			const size_t index = component_indexes_[component_id];
+			components_[index].graph->AddEdge({ local_ids_[edge.from], local_ids_[edge.to], edge.weight });
+			added_edges[index - first_index].push_back(edge_id);
+		}
+		for (size_t index = first_index; index < components_.size(); ++index) {
+			auto& component = components_[index];
+			const auto new_edge_ids = component.graph->Freeze();
+			component.edges.resize(new_edge_ids.size());
+			for (EdgeId edge_id = 0; edge_id < new_edge_ids.size(); ++edge_id) {
+				component.edges[new_edge_ids[edge_id]] = added_edges[index - first_index][edge_id];
+			}
+			component.router = router_factory_(*component.graph, component.vertices);
+		}
+	}
+
+	template <typename Weight>
+	std::optional<typename ComponentRouter<Weight>::RouteInfo> ComponentRouter<Weight>::BuildRoute(VertexId from,
+		VertexId to) const {
+		CheckVertex(from);
+		CheckVertex(to);
+		if (component_ids_[from] != component_ids_[to]) {
+			return std::nullopt;
+		}
+		const size_t index = component_indexes_[component_ids_[from]];
+		// изолированная вершина: путь есть только в неё саму
+		if (index == NO_COMPONENT) {
+			return RouteInfo{ ZERO_WEIGHT, {} };
+		}
+		const auto& component = components_[index];
+		auto route = component.router->BuildRoute(local_ids_[from], local_ids_[to]);
+		if (route && component.graph != nullptr) {
+			for (EdgeId& edge_id : route->edges) {
+				edge_id = component.edges[edge_id];
+			}
+		}
+		return route;
+	}
+
+	template <typename Weight>
+	std::optional<Weight> ComponentRouter<Weight>::BuildRouteWeight(VertexId from, VertexId to) const {
+		CheckVertex(from);
+		CheckVertex(to);
+		if (component_ids_[from] != component_ids_[to]) {
+			return std::nullopt;
+		}
+		const size_t index = component_indexes_[component_ids_[from]];
+		if (index == NO_COMPONENT) {
+			return ZERO_WEIGHT;
+		}
+		return components_[index].router->BuildRouteWeight(local_ids_[from], local_ids_[to]);
+	}
+
+	template <typename Weight>
+	std::vector<std::vector<std::optional<Weight>>> ComponentRouter<Weight>::BuildWeightMatrix(
+		const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+		std::vector<std::vector<std::optional<Weight>>> result(sources.size(),
+			std::vector<std::optional<Weight>>(targets.size()));
+		// источники и цели каждой компоненты: позиции в запросе и локальные id
+		struct ComponentQuery {
+			std::vector<size_t> source_positions;
+			std::vector<VertexId> sources;
+			std::vector<size_t> target_positions;
+			std::vector<VertexId> targets;
+		};
+		std::vector<ComponentQuery> queries(components_.size());
+		for (size_t i = 0; i < sources.size(); ++i) {
+			CheckVertex(sources[i]);
+			const size_t index = component_indexes_[component_ids_[sources[i]]];
+			if (index != NO_COMPONENT) {
+				queries[index].source_positions.push_back(i);
+				queries[index].sources.push_back(local_ids_[sources[i]]);
+			}
+		}
+		for (size_t j = 0; j < targets.size(); ++j) {
+			CheckVertex(targets[j]);
+			const size_t index = component_indexes_[component_ids_[targets[j]]];
+			if (index != NO_COMPONENT) {
+				queries[index].target_positions.push_back(j);
+				queries[index].targets.push_back(local_ids_[targets[j]]);
+			}
+			else {
+				// изолированная вершина достижима только из себя самой
+				for (size_t i = 0; i < sources.size(); ++i) {
+					if (sources[i] == targets[j]) {
+						result[i][j] = ZERO_WEIGHT;
+					}
+				}
+			}
+		}
+		for (size_t index = 0; index < components_.size(); ++index) {
+			const auto& query = queries[index];
+			if (query.sources.empty() || query.targets.empty()) {
+				continue;
+			}
+			const auto weights = components_[index].router->BuildWeightMatrix(query.sources, query.targets);
+			for (size_t i = 0; i < query.sources.size(); ++i) {
+				for (size_t j = 0; j < query.targets.size(); ++j) {
+					result[query.source_positions[i]][query.target_positions[j]] = weights[i][j];
+				}
+			}
+		}
+		return result;
+	}
+
+	template <typename Weight>
+	bool ComponentRouter<Weight>::Update(const std::vector<EdgeId>& new_edge_ids) {
+		if (new_edge_ids.size() != graph_.GetEdgeCount() || new_edge_ids.size() < edge_count_) {
+			throw std::invalid_argument("Edge renumbering doesn't match the graph");
+		}
+		const size_t vertex_count = graph_.GetVertexCount();
+		const size_t old_vertex_count = local_ids_.size();
+
+		// движок построен по всему графу: обновляется он сам, id вершин остаются исходными
+		if (components_.size() == 1 && components_.front().graph == nullptr) {
+			if (!components_.front().router->Update(new_edge_ids)) {
+				return false;
+			}
+			FindComponents();
+			component_indexes_.assign(component_count_, NO_COMPONENT);
+			for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+				component_indexes_[component_ids_[graph_.GetEdge(edge_id).from]] = 0;
+			}
+			auto& vertices = components_.front().vertices;
+			vertices.resize(vertex_count);
+			std::iota(vertices.begin() + old_vertex_count, vertices.end(), old_vertex_count);
+			local_ids_ = vertices;
+			edge_count_ = new_edge_ids.size();
+			return true;
+		}
+
+		const std::vector<size_t> old_component_ids = std::move(component_ids_);
+		const std::vector<size_t> old_component_indexes = std::move(component_indexes_);
+		auto old_index = [&](VertexId vertex) {
+			return vertex < old_vertex_count ? old_component_indexes[old_component_ids[vertex]] : NO_COMPONENT;
+		};
+		FindComponents();
+		local_ids_.resize(vertex_count, 0);
+
+		// прежние компоненты с рёбрами, вошедшие в каждую новую компоненту: их число и индекс последней
+		std::vector<size_t> old_counts(component_count_, 0);
+		std::vector<size_t> old_indexes(component_count_, NO_COMPONENT);
+		for (size_t index = 0; index < components_.size(); ++index) {
+			const size_t component_id = component_ids_[components_[index].vertices.front()];
+			++old_counts[component_id];
+			old_indexes[component_id] = index;
+		}
+		// вершины и рёбра, дополняющие компоненты, в которые вошла ровно одна прежняя компонента с рёбрами
+		std::vector<std::vector<VertexId>> added_vertices(component_count_);
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			const size_t component_id = component_ids_[vertex];
+			if (old_counts[component_id] == 1 && old_index(vertex) != old_indexes[component_id]) {
+				added_vertices[component_id].push_back(vertex);
+			}
+		}
+		std::vector<std::vector<EdgeId>> added_edges(component_count_);
+		for (EdgeId edge_id = edge_count_; edge_id < new_edge_ids.size(); ++edge_id) {
+			const size_t component_id = component_ids_[graph_.GetEdge(new_edge_ids[edge_id]).from];
+			if (old_counts[component_id] == 1) {
+				added_edges[component_id].push_back(new_edge_ids[edge_id]);
+			}
+		}
+
+		std::vector<Component> components;
+		component_indexes_.assign(component_count_, NO_COMPONENT);
+		// компоненты, движки которых строятся заново: слившиеся и не содержавшие прежде рёбер
+		std::vector<bool> rebuilt(component_count_, false);
+		for (size_t component_id = 0; component_id < component_count_; ++component_id) {
+			if (old_counts[component_id] != 1) {
+				rebuilt[component_id] = old_counts[component_id] > 1;
+				continue;
+			}
+			auto& component = components_[old_indexes[component_id]];
+			// старые рёбра получают новые id исходного графа
+			for (EdgeId& edge_id : component.edges) {
+				edge_id = new_edge_ids[edge_id];
+			}
+			if (!added_edges[component_id].empty()) {
+				auto& component_graph = *component.graph;
+				component_graph.Unfreeze();
+				component_graph.AddVertices(added_vertices[component_id].size());
+				for (const VertexId vertex : added_vertices[component_id]) {
+					local_ids_[vertex] = component.vertices.size();
+					component.vertices.push_back(vertex);
+				}
+				for (const EdgeId edge_id : added_edges[component_id]) {
+					const auto& edge = graph_.GetEdge(edge_id);
+					component_graph.AddEdge({ local_ids_[edge.from], local_ids_[edge.to], edge.weight });
+					component.edges.push_back(edge_id);
+				}
+				const auto local_edge_ids = component_graph.Freeze();
+				std::vector<EdgeId> edges(component.edges.size());
+				for (EdgeId edge_id = 0; edge_id < local_edge_ids.size(); ++edge_id) {
+					edges[local_edge_ids[edge_id]] = component.edges[edge_id];
+				}
+				component.edges = std::move(edges);
+				if (!component.router->Update(local_edge_ids)) {
+					component.router = router_factory_(component_graph, component.vertices);
+				}
+			}
+			component_indexes_[component_id] = components.size();
+			components.push_back(std::move(component));
+		}
+		// компоненты, появившиеся только из новых рёбер
+		for (EdgeId edge_id = edge_count_; edge_id < new_edge_ids.size(); ++edge_id) {
+			const size_t component_id = component_ids_[graph_.GetEdge(new_edge_ids[edge_id]).from];
+			if (old_counts[component_id] == 0) {
+				rebuilt[component_id] = true;
+			}
+		}
+		components_ = std::move(components);
+		AddComponents(rebuilt);
+		edge_count_ = new_edge_ids.size();
+		return true;
+	}
+
+	template <typename Weight>
+	SearchStats ComponentRouter<Weight>::GetSearchStats() const {
+		SearchStats stats;
+		for (const auto& component : components_) {
+			const auto component_stats = component.router->GetSearchStats();
+			stats.queries += component_stats.queries;
+			stats.settled_vertices += component_stats.settled_vertices;
+		}
+		return stats;
+	}
+
+	template <typename Weight>
+	size_t ComponentRouter<Weight>::GetComponentCount() const {
+		return component_count_;
+	}
+
+	template <typename Weight>
+	std::vector<const RouterBase<Weight>*> ComponentRouter<Weight>::GetComponentRouters() const {
+		std::vector<const RouterBase<Weight>*> routers;
+		routers.reserve(components_.size());
+		for (const auto& component : components_) {
+			routers.push_back(component.router.get());
+		}
+		return routers;
+	}
+}  // namespace graph
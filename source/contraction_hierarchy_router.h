@@ -0,0 +1,579 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+	/// @brief Маршрутизатор на основе иерархий сжатия (Contraction Hierarchies)
+	/// @details При построении вершины графа по очереди «сжимаются»: вместо удаляемой вершины добавляются
+	/// рёбра-сокращения (shortcuts), сохраняющие кратчайшие пути между её соседями. Запрос выполняется
+	/// двунаправленным поиском только по рёбрам, ведущим к вершинам с большим рангом.
+	/// Каждое сокращение помнит два ребра, из которых оно составлено, поэтому найденный путь
+	/// разворачивается в исходные рёбра графа
+	template <typename Weight>
+	class ContractionHierarchyRouter : public RouterBase<Weight> {
+	private:
+		using Graph = DirectedWeightedGraph<Weight>;
+
+	public:
+		using typename RouterBase<Weight>::RouteInfo;
+
+		explicit ContractionHierarchyRouter(const Graph& graph);
+
+		std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+		/// @brief Тот же двунаправленный поиск без разворачивания сокращений
+		/// @details Вес берётся из поиска, а не суммируется по рёбрам пути, поэтому может отличаться
+		/// от веса BuildRoute на погрешность округления
+		std::optional<Weight> BuildRouteWeight(VertexId from, VertexId to) const override;
+
+		/// @brief Расчёт «многие ко многим» с корзинами: обратный поиск вверх от каждой цели раскладывает
+		/// расстояния по корзинам вершин, прямой поиск вверх от каждого источника их просматривает
+		std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+			const std::vector<VertexId>& targets) const override;
+
+		/// @brief Число рёбер-сокращений, добавленных при построении
+		size_t GetShortcutCount() const;
+
+		static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+		/// @brief ребро иерархии: исходное ребро графа или сокращение из двух рёбер иерархии
+		struct HierarchyEdge {
+			VertexId from;
+			VertexId to;
+			Weight weight;
+			EdgeId first_child = NO_EDGE;
+			EdgeId second_child = NO_EDGE;
+		};
+
+		/// @brief вершина пространства поиска вверх
+		struct SearchSpaceEntry {
+			VertexId vertex;
+			// расстояние от начальной вершины поиска (до неё - при обратном поиске)
+			Weight weight;
+			// ребро иерархии, по которому вершина достигнута; NO_EDGE у начальной вершины
+			EdgeId parent_edge;
+		};
+
+		/// @brief рабочие массивы поиска вверх, переиспользуемые между поисками
+		/// @details Между поисками все элементы пусты (поиск возвращает их в исходное состояние)
+		struct UpwardSearchWorkspace {
+			explicit UpwardSearchWorkspace(size_t vertex_count)
+				: weights(vertex_count)
+				, prev_edges(vertex_count, NO_EDGE) {
+			}
+
+			std::vector<std::optional<Weight>> weights;
+			std::vector<EdgeId> prev_edges;
+		};
+
+		const HierarchyEdge& GetHierarchyEdge(EdgeId edge_id) const {
+			return edges_.at(edge_id);
+		}
+
+		/// @brief Разворачивание ребра иерархии в исходные рёбра графа
+		/// @param edge_id ребро иерархии
+		/// @param edges исходные рёбра в порядке пути (дописываются в конец)
+		void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+		/// @brief Полный поиск вверх по иерархии из вершины
+		/// @param start начальная вершина
+		/// @param forward направление поиска: по рёбрам к вершинам большего ранга (true)
+		/// или против рёбер из вершин большего ранга (false)
+		/// @param workspace рабочие массивы поиска
+		/// @return окончательно найденные вершины в порядке просмотра
+		std::vector<SearchSpaceEntry> GetUpwardSearchSpace(VertexId start, bool forward,
+			UpwardSearchWorkspace& workspace) const;
+
+	private:
+		// максимальное число вершин, просматриваемых при поиске пути-свидетеля
+		static constexpr size_t WITNESS_SETTLED_LIMIT = 500;
+
+		using QueueItem = std::pair<Weight, VertexId>;
+
+		struct QueueItemGreater {
+			bool operator()(const QueueItem& lhs, const QueueItem& rhs) const {
+				return rhs.first < lhs.first;
+			}
+		};
+
+		using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, QueueItemGreater>;
+
+		/// @brief Упорядочивание и сжатие вершин графа
+		void Contract(size_t vertex_count);
+
+		/// @brief Сжатие вершины
+		/// @param vertex сжимаемая вершина
+		/// @param simulate только подсчитать число необходимых сокращений, не добавляя их
+		/// @return число необходимых сокращений
+		size_t ContractVertex(VertexId vertex, bool simulate);
+
+		/// @brief Приоритет сжатия вершины (чем меньше, тем раньше сжимается)
+		long ComputePriority(VertexId vertex);
+
+		/// @brief Поиск пути-свидетеля в обход сжимаемой вершины
+		/// @param source начальная вершина поиска
+		/// @param excluded сжимаемая вершина
+		/// @param max_weight вес, дальше которого искать не нужно
+		void RunWitnessSearch(VertexId source, VertexId excluded, const Weight& max_weight);
+
+		/// @brief Соседи вершины среди несжатых вершин с минимальным весом ребра до каждого
+		std::vector<std::pair<VertexId, Weight>> CollectNeighbours(const std::vector<EdgeId>& edge_ids,
+			VertexId vertex, bool outgoing) const;
+
+		/// @brief Двунаправленный поиск вверх по иерархии
+		/// @param forward_prev_edges, backward_prev_edges рёбра иерархии, по которым достигнуты вершины
+		/// @param meeting_vertex вершина встречи поисков на кратчайшем пути
+		/// @return вес кратчайшего пути; std::nullopt, если пути нет
+		std::optional<Weight> RunBidirectionalSearch(VertexId from, VertexId to, std::vector<EdgeId>& forward_prev_edges,
+			std::vector<EdgeId>& backward_prev_edges, VertexId& meeting_vertex) const;
+
+		/// @brief Шаг одного из направлений двунаправленного поиска
+		void SettleNext(Queue& queue, std::vector<std::optional<Weight>>& weights,
+			std::vector<EdgeId>& prev_edges, const std::vector<std::optional<Weight>>& opposite_weights,
+			const std::vector<std::vector<EdgeId>>& adjacency, bool forward,
+			std::optional<Weight>& best_weight, VertexId& meeting_vertex) const;
+
+		static constexpr Weight ZERO_WEIGHT{};
+		const Graph& graph_;
+		// рёбра иерархии: первые GetEdgeCount() совпадают с рёбрами графа, далее сокращения
+		std::vector<HierarchyEdge> edges_;
+		// ранг (порядковый номер сжатия) вершин
+		std::vector<size_t> ranks_;
+		// рёбра из вершины к вершинам большего ранга (прямой поиск)
+		std::vector<std::vector<EdgeId>> upward_out_edges_;
+		// рёбра в вершину из вершин большего ранга (обратный поиск)
+		std::vector<std::vector<EdgeId>> upward_in_edges_;
+
+		// данные, используемые только при построении иерархии
+		std::vector<std::vector<EdgeId>> out_edges_;
+		std::vector<std::vector<EdgeId>> in_edges_;
+		std::vector<bool> contracted_;
+		std::vector<size_t> contracted_neighbours_;
+		std::vector<std::optional<Weight>> witness_weights_;
+		std::vector<VertexId> witness_touched_;
+	};
+
+	template <typename Weight>
+	ContractionHierarchyRouter<Weight>::ContractionHierarchyRouter(const Graph& graph)
+		: graph_(graph)
+	{
+		const size_t vertex_count = graph.GetVertexCount();
+		out_edges_.resize(vertex_count);
+		in_edges_.resize(vertex_count);
+		edges_.reserve(graph.GetEdgeCount());
+		// рёбра замороженного графа упорядочены по начальной вершине, id совпадает с позицией
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+				const auto& arc = graph.GetArc(edge_id);
+				if (arc.weight < ZERO_WEIGHT) {
+					throw std::domain_error("Edges' weights should be non-negative");
+				}
+				edges_.push_back({ vertex, arc.to, arc.weight });
+				out_edges_[vertex].push_back(edge_id);
+				in_edges_[arc.to].push_back(edge_id);
+			}
+		}
+
+		Contract(vertex_count);
+
+		upward_out_edges_.resize(vertex_count);
+		upward_in_edges_.resize(vertex_count);
+		for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+			const auto& edge = edges_[edge_id];
+			if (ranks_[edge.from] < ranks_[edge.to]) {
+				upward_out_edges_[edge.from].push_back(edge_id);
+			}
+			else if (ranks_[edge.to] < ranks_[edge.from]) {
+				upward_in_edges_[edge.to].push_back(edge_id);
+			}
+		}
+
+		// данные построения больше не нужны
+		out_edges_ = {};
+		in_edges_ = {};
+		contracted_ = {};
+		contracted_neighbours_ = {};
+		witness_weights_ = {};
+		witness_touched_ = {};
+	}
+
+	template <typename Weight>
+	void ContractionHierarchyRouter<Weight>::Contract(size_t vertex_count) {
+		contracted_.assign(vertex_count, false);
+		contracted_neighbours_.assign(vertex_count, 0);
+		witness_weights_.assign(vertex_count, std::nullopt);
+		ranks_.assign(vertex_count, 0);
+
+		using PriorityItem = std::pair<long, VertexId>;
+		std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			queue.push({ ComputePriority(vertex), vertex });
+		}
+
+		size_t rank = 0;
+		while (!queue.empty()) {
+			const VertexId vertex = queue.top().second;
+			queue.pop();
+			// ленивое обновление: приоритет мог вырасти после сжатия соседей
+			const long priority = ComputePriority(vertex);
+			if (!queue.empty() && priority > queue.top().first) {
+				queue.push({ priority, vertex });
+				continue;
+			}
+			ContractVertex(vertex, false);
+			contracted_[vertex] = true;
+			ranks_[vertex] = rank++;
+			for (const EdgeId edge_id : out_edges_[vertex]) {
+				++contracted_neighbours_[edges_[edge_id].to];
+			}
+			for (const EdgeId edge_id : in_edges_[vertex]) {
+				++contracted_neighbours_[edges_[edge_id].from];
+			}
+		}
+	}
+
+	template <typename Weight>
+	long ContractionHierarchyRouter<Weight>::ComputePriority(VertexId vertex) {
+		const long shortcuts = static_cast<long>(ContractVertex(vertex, true));
+		const long removed = static_cast<long>(CollectNeighbours(in_edges_[vertex], vertex, false).size()
+			+ CollectNeighbours(out_edges_[vertex], vertex, true).size());
+		// разность рёбер плюс число уже сжатых соседей для равномерности сжатия
+		return shortcuts - removed + static_cast<long>(contracted_neighbours_[vertex]);
+	}
+
+	template <typename Weight>
+	std::vector<std::pair<VertexId, Weight>> ContractionHierarchyRouter<Weight>::CollectNeighbours(
+		const std::vector<EdgeId>& edge_ids, VertexId vertex, bool outgoing) const {
+		std::vector<std::pair<VertexId, Weight>> neighbours;
+		for (const EdgeId edge_id : edge_ids) {
+			const auto& edge = edges_[edge_id];
+			const VertexId neighbour = outgoing ? edge.to : edge.from;
+			if (neighbour == vertex || contracted_[neighbour]) {
+				continue;
+			}
+			neighbours.push_back({ neighbour, edge.weight });
+		}
+		std::sort(neighbours.begin(), neighbours.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+			});
+		// оставляем по одному (самому лёгкому) ребру на соседа
+		neighbours.erase(std::unique(neighbours.begin(), neighbours.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.first == rhs.first;
+			}), neighbours.end());
+		return neighbours;
+	}
+
+	template <typename Weight>
+	void ContractionHierarchyRouter<Weight>::RunWitnessSearch(VertexId source, VertexId excluded,
+		const Weight& max_weight) {
+		for (const VertexId vertex : witness_touched_) {
+			witness_weights_[vertex] = std::nullopt;
+		}
+		witness_touched_.clear();
+
+		Queue queue;
+		witness_weights_[source] = ZERO_WEIGHT;
+		witness_touched_.push_back(source);
+		queue.push({ ZERO_WEIGHT, source });
+		size_t settled_count = 0;
+		while (!queue.empty() && settled_count < WITNESS_SETTLED_LIMIT) {
+			const auto [weight, vertex] = queue.top();
+			queue.pop();
+			if (*witness_weights_[vertex] < weight) {
+				continue;
+			}
+			if (max_weight < weight) {
+				break;
+			}
+			++settled_count;
+			for (const EdgeId edge_id : out_edges_[vertex]) {
+				const auto& edge = edges_[edge_id];
+				if (edge.to == excluded || contracted_[edge.to]) {
+					continue;
+				}
+				const Weight candidate_weight = weight + edge.weight;
+				auto& weight_to = witness_weights_[edge.to];
+				if (!weight_to || candidate_weight < *weight_to) {
+					if (!weight_to) {
+						witness_touched_.push_back(edge.to);
+					}
+					weight_to = candidate_weight;
+					queue.push({ candidate_weight, edge.to });
+				}
+			}
+		}
+	}
+
+	template <typename Weight>
+	size_t ContractionHierarchyRouter<Weight>::ContractVertex(VertexId vertex, bool simulate) {
+		const auto in_neighbours = CollectNeighbours(in_edges_[vertex], vertex, false);
+		const auto out_neighbours = CollectNeighbours(out_edges_[vertex], vertex, true);
+		if (in_neighbours.empty() || out_neighbours.empty()) {
+			return 0;
+		}
+
+		size_t shortcut_count = 0;
+		for (const auto& [from, weight_in] : in_neighbours) {
+			Weight max_weight = ZERO_WEIGHT;
+			for (const auto& [to, weight_out] : out_neighbours) {
+				const Weight candidate_weight = weight_in + weight_out;
+				if (max_weight < candidate_weight) {
+					max_weight = candidate_weight;
+				}
+			}
+			RunWitnessSearch(from, vertex, max_weight);
+
+			for (const auto& [to, weight_out] : out_neighbours) {
+				if (to == from) {
+					continue;
+				}
+				const Weight candidate_weight = weight_in + weight_out;
+				const auto& witness_weight = witness_weights_[to];
+				// путь в обход вершины не длиннее пути через неё: сокращение не нужно
+				if (witness_weight && !(candidate_weight < *witness_weight)) {
+					continue;
+				}
+				++shortcut_count;
+				if (simulate) {
+					continue;
+				}
+				// рёбра, из которых составлено сокращение (самые лёгкие между парами вершин)
+				EdgeId first_child = NO_EDGE;
+				for (const EdgeId edge_id : in_edges_[vertex]) {
+					const auto& edge = edges_[edge_id];
+					if (edge.from == from && (first_child == NO_EDGE || edge.weight < edges_[first_child].weight)) {
+						first_child = edge_id;
+					}
+				}
+				EdgeId second_child = NO_EDGE;
+				for (const EdgeId edge_id : out_edges_[vertex]) {
+					const auto& edge = edges_[edge_id];
+					if (edge.to == to && (second_child == NO_EDGE || edge.weight < edges_[second_child].weight)) {
+						second_child = edge_id;
+					}
+				}
+				const EdgeId shortcut_id = edges_.size();
+				edges_.push_back({ from, to, candidate_weight, first_child, second_child });
+				out_edges_[from].push_back(shortcut_id);
+				in_edges_[to].push_back(shortcut_id);
+			}
+		}
+		return shortcut_count;
+	}
+
+	template <typename Weight>
+	size_t ContractionHierarchyRouter<Weight>::GetShortcutCount() const {
+		return edges_.size() - graph_.GetEdgeCount();
+	}
+
+	template <typename Weight>
+	void ContractionHierarchyRouter<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+		std::vector<EdgeId> stack{ edge_id };
+		while (!stack.empty()) {
+			const EdgeId current_id = stack.back();
+			stack.pop_back();
+			const auto& edge = edges_[current_id];
+			if (edge.first_child == NO_EDGE) {
+				edges.push_back(current_id);
+				continue;
+			}
+			// второе ребро кладём первым, чтобы первое было развёрнуто раньше
+			stack.push_back(edge.second_child);
+			stack.push_back(edge.first_child);
+		}
+	}
+
+	template <typename Weight>
+	void ContractionHierarchyRouter<Weight>::SettleNext(Queue& queue, std::vector<std::optional<Weight>>& weights,
+		std::vector<EdgeId>& prev_edges, const std::vector<std::optional<Weight>>& opposite_weights,
+		const std::vector<std::vector<EdgeId>>& adjacency, bool forward,
+		std::optional<Weight>& best_weight, VertexId& meeting_vertex) const {
+		const auto [weight, vertex] = queue.top();
+		queue.pop();
+		if (*weights[vertex] < weight) {
+			return;
+		}
+		if (opposite_weights[vertex]) {
+			const Weight candidate_weight = weight + *opposite_weights[vertex];
+			if (!best_weight || candidate_weight < *best_weight) {
+				best_weight = candidate_weight;
+				meeting_vertex = vertex;
+			}
+		}
+		for (const EdgeId edge_id : adjacency[vertex]) {
+			const auto& edge = edges_[edge_id];
+			const VertexId next = forward ? edge.to : edge.from;
+			const Weight candidate_weight = weight + edge.weight;
+			auto& weight_next = weights[next];
+			if (!weight_next || candidate_weight < *weight_next) {
+				weight_next = candidate_weight;
+				prev_edges[next] = edge_id;
+				queue.push({ candidate_weight, next });
+			}
+		}
+	}
+
+	template <typename Weight>
+	std::optional<Weight> ContractionHierarchyRouter<Weight>::RunBidirectionalSearch(VertexId from, VertexId to,
+		std::vector<EdgeId>& forward_prev_edges, std::vector<EdgeId>& backward_prev_edges,
+		VertexId& meeting_vertex) const {
+		const size_t vertex_count = graph_.GetVertexCount();
+		if (from >= vertex_count || to >= vertex_count) {
+			throw std::out_of_range("Vertex id is out of range");
+		}
+		std::vector<std::optional<Weight>> forward_weights(vertex_count);
+		std::vector<std::optional<Weight>> backward_weights(vertex_count);
+		forward_prev_edges.assign(vertex_count, NO_EDGE);
+		backward_prev_edges.assign(vertex_count, NO_EDGE);
+		Queue forward_queue;
+		Queue backward_queue;
+
+		forward_weights[from] = ZERO_WEIGHT;
+		forward_queue.push({ ZERO_WEIGHT, from });
+		backward_weights[to] = ZERO_WEIGHT;
+		backward_queue.push({ ZERO_WEIGHT, to });
+
+		std::optional<Weight> best_weight;
+		meeting_vertex = from;
+		while (!forward_queue.empty() || !backward_queue.empty()) {
+			// поиск в направлении завершён, если его фронт не короче лучшего найденного пути
+			if (!forward_queue.empty() && best_weight && !(forward_queue.top().first < *best_weight)) {
+				forward_queue = {};
+			}
+			if (!backward_queue.empty() && best_weight && !(backward_queue.top().first < *best_weight)) {
+				backward_queue = {};
+			}
+			if (!forward_queue.empty()) {
+				SettleNext(forward_queue, forward_weights, forward_prev_edges, backward_weights,
+					upward_out_edges_, true, best_weight, meeting_vertex);
+			}
+			if (!backward_queue.empty()) {
+				SettleNext(backward_queue, backward_weights, backward_prev_edges, forward_weights,
+					upward_in_edges_, false, best_weight, meeting_vertex);
+			}
+		}
+
+		return best_weight;
+	}
+
+	template <typename Weight>
+	std::optional<typename ContractionHierarchyRouter<Weight>::RouteInfo>
+		ContractionHierarchyRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+		std::vector<EdgeId> forward_prev_edges;
+		std::vector<EdgeId> backward_prev_edges;
+		VertexId meeting_vertex = from;
+		if (!RunBidirectionalSearch(from, to, forward_prev_edges, backward_prev_edges, meeting_vertex)) {
+			return std::nullopt;
+		}
+
+		// рёбра иерархии от начала до точки встречи и от точки встречи до конца
+		std::vector<EdgeId> hierarchy_edges;
+		for (VertexId vertex = meeting_vertex; forward_prev_edges[vertex] != NO_EDGE;
+			vertex = edges_[forward_prev_edges[vertex]].from) {
+			hierarchy_edges.push_back(forward_prev_edges[vertex]);
+		}
+		std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+		for (VertexId vertex = meeting_vertex; backward_prev_edges[vertex] != NO_EDGE;
+			vertex = edges_[backward_prev_edges[vertex]].to) {
+			hierarchy_edges.push_back(backward_prev_edges[vertex]);
+		}
+
+		std::vector<EdgeId> edges;
+		for (const EdgeId edge_id : hierarchy_edges) {
+			UnpackEdge(edge_id, edges);
+		}
+		// вес пересчитывается по исходным рёбрам в порядке пути, как при поиске Дейкстрой
+		Weight weight = ZERO_WEIGHT;
+		for (const EdgeId edge_id : edges) {
+			weight = weight + graph_.GetEdge(edge_id).weight;
+		}
+		return RouteInfo{ weight, std::move(edges) };
+	}
+
+	template <typename Weight>
+	std::optional<Weight> ContractionHierarchyRouter<Weight>::BuildRouteWeight(VertexId from, VertexId to) const {
+		std::vector<EdgeId> forward_prev_edges;
+		std::vector<EdgeId> backward_prev_edges;
+		VertexId meeting_vertex = from;
+		return RunBidirectionalSearch(from, to, forward_prev_edges, backward_prev_edges, meeting_vertex);
+	}
+
+	template <typename Weight>
+	std::vector<typename ContractionHierarchyRouter<Weight>::SearchSpaceEntry>
+		ContractionHierarchyRouter<Weight>::GetUpwardSearchSpace(VertexId start, bool forward,
+			UpwardSearchWorkspace& workspace) const {
+		if (start >= graph_.GetVertexCount()) {
+			throw std::out_of_range("Vertex id is out of range");
+		}
+		const auto& adjacency = forward ? upward_out_edges_ : upward_in_edges_;
+		auto& weights = workspace.weights;
+		auto& prev_edges = workspace.prev_edges;
+		std::vector<SearchSpaceEntry> settled;
+		Queue queue;
+		weights[start] = ZERO_WEIGHT;
+		queue.push({ ZERO_WEIGHT, start });
+		while (!queue.empty()) {
+			const auto [weight, vertex] = queue.top();
+			queue.pop();
+			if (*weights[vertex] < weight) {
+				continue;
+			}
+			settled.push_back({ vertex, weight, prev_edges[vertex] });
+			for (const EdgeId edge_id : adjacency[vertex]) {
+				const auto& edge = edges_[edge_id];
+				const VertexId next = forward ? edge.to : edge.from;
+				const Weight candidate_weight = weight + edge.weight;
+				auto& weight_next = weights[next];
+				if (!weight_next || candidate_weight < *weight_next) {
+					weight_next = candidate_weight;
+					prev_edges[next] = edge_id;
+					queue.push({ candidate_weight, next });
+				}
+			}
+		}
+		// поиск полный: все достигнутые вершины просмотрены, сбрасываем только их
+		for (const auto& entry : settled) {
+			weights[entry.vertex] = std::nullopt;
+			prev_edges[entry.vertex] = NO_EDGE;
+		}
+		return settled;
+	}
+
+	template <typename Weight>
+	std::vector<std::vector<std::optional<Weight>>> ContractionHierarchyRouter<Weight>::BuildWeightMatrix(
+		const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+		// корзины: для вершины - пары (номер цели, расстояние от вершины до цели)
+		std::vector<std::vector<std::pair<size_t, Weight>>> buckets(graph_.GetVertexCount());
+		UpwardSearchWorkspace workspace(graph_.GetVertexCount());
+		for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+			for (const auto& entry : GetUpwardSearchSpace(targets[target_index], false, workspace)) {
+				buckets[entry.vertex].push_back({ target_index, entry.weight });
+			}
+		}
+
+		std::vector<std::vector<std::optional<Weight>>> result(sources.size(),
+			std::vector<std::optional<Weight>>(targets.size()));
+		for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+			auto& row = result[source_index];
+			for (const auto& entry : GetUpwardSearchSpace(sources[source_index], true, workspace)) {
+				for (const auto& [target_index, target_weight] : buckets[entry.vertex]) {
+					const Weight candidate_weight = entry.weight + target_weight;
+					if (!row[target_index] || candidate_weight < *row[target_index]) {
+						row[target_index] = candidate_weight;
+					}
+				}
+			}
+		}
+		return result;
+	}
+}  // namespace graph
@@ -0,0 +1,307 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+	/// @brief Маршрутизатор, ищущий путь по запросу алгоритмом Дейкстры с двоичной кучей
+	/// @details Не требует предварительного расчёта: память O(V+E), время запроса O((V+E)logV)
+	template <typename Weight>
+	class DijkstraRouter : public RouterBase<Weight> {
+	private:
+		using Graph = DirectedWeightedGraph<Weight>;
+
+	public:
+		using typename RouterBase<Weight>::RouteInfo;
+
+		explicit DijkstraRouter(const Graph& graph);
+
+		std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+		/// @brief Тот же поиск, но без восстановления пути по последним рёбрам
+		std::optional<Weight> BuildRouteWeight(VertexId from, VertexId to) const override;
+
+		/// @brief Один поиск из каждого источника, завершаемый после достижения всех целей
+		std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+			const std::vector<VertexId>& targets) const override;
+
+		SearchStats GetSearchStats() const override;
+
+		static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+		/// @brief дерево кратчайших путей из одной вершины до всех достижимых
+		struct ShortestPathTree {
+			VertexId root;
+			// вес пути от корня; у недостижимых вершин не определён
+			std::vector<Weight> weights;
+			// последнее ребро пути от корня; NO_EDGE у корня и недостижимых вершин
+			std::vector<EdgeId> prev_edges;
+
+			bool IsReachable(VertexId vertex) const {
+				return vertex == root || prev_edges[vertex] != NO_EDGE;
+			}
+
+			/// @brief Память, занимаемая деревом графа из vertex_count вершин, байт
+			static size_t GetMemorySize(size_t vertex_count) {
+				return vertex_count * (sizeof(Weight) + sizeof(EdgeId));
+			}
+		};
+
+		/// @brief Полный поиск из вершины: кратчайшие пути до всех вершин графа
+		ShortestPathTree BuildShortestPathTree(VertexId from) const;
+
+		/// @brief Путь от корня дерева до вершины за время, пропорциональное длине пути
+		/// @return std::nullopt, если вершина недостижима из корня
+		std::optional<RouteInfo> BuildRoute(const ShortestPathTree& tree, VertexId to) const;
+
+		/// @brief Поиск из вершины, ограниченный весом пути
+		/// @details Просматриваются только вершины, до которых путь не длиннее max_weight, и исходящие из них
+		/// рёбра; рабочие данные хранятся в хэш-таблице, поэтому время и память не зависят от размера графа
+		/// @return вершины в порядке неубывания веса пути (первая - сама вершина from) и веса путей до них
+		std::vector<std::pair<VertexId, Weight>> FindReachable(VertexId from, Weight max_weight) const;
+
+	private:
+		// элемент очереди с приоритетом: расстояние до вершины и сама вершина
+		using QueueItem = std::pair<Weight, VertexId>;
+
+		struct QueueItemGreater {
+			bool operator()(const QueueItem& lhs, const QueueItem& rhs) const {
+				return rhs.first < lhs.first;
+			}
+		};
+
+		/// @brief Поиск кратчайших путей из вершины, пока не будут окончательно найдены пути до всех целей
+		/// @param from вершина отправления
+		/// @param targets целевые вершины
+		/// @param weights кратчайшие расстояния (размер - число вершин)
+		/// @param prev_edges последние рёбра найденных путей (размер - число вершин)
+		void Sweep(VertexId from, const std::vector<VertexId>& targets, std::vector<std::optional<Weight>>& weights,
+			std::vector<std::optional<EdgeId>>& prev_edges) const;
+
+		void CheckVertex(VertexId vertex) const {
+			if (vertex >= graph_.GetVertexCount()) {
+				throw std::out_of_range("Vertex id is out of range");
+			}
+		}
+
+		static constexpr Weight ZERO_WEIGHT{};
+		const Graph& graph_;
+		// счётчики для статистики поисков
+		mutable std::atomic<size_t> query_count_{ 0 };
+		mutable std::atomic<size_t> settled_count_{ 0 };
+	};
+
+	template <typename Weight>
+	DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+		: graph_(graph)
+	{
+		if (!graph.IsFrozen()) {
+			throw std::logic_error("Graph should be frozen before routing");
+		}
+		for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+			if (graph.GetArc(edge_id).weight < ZERO_WEIGHT) {
+				throw std::domain_error("Edges' weights should be non-negative");
+			}
+		}
+	}
+
+	template <typename Weight>
+	void DijkstraRouter<Weight>::Sweep(VertexId from, const std::vector<VertexId>& targets,
+		std::vector<std::optional<Weight>>& weights, std::vector<std::optional<EdgeId>>& prev_edges) const {
+		// число различных целей, пути до которых ещё не найдены окончательно
+		std::vector<bool> is_target(graph_.GetVertexCount(), false);
+		size_t targets_left = 0;
+		for (const VertexId target : targets) {
+			CheckVertex(target);
+			if (!is_target[target]) {
+				is_target[target] = true;
+				++targets_left;
+			}
+		}
+		std::priority_queue<QueueItem, std::vector<QueueItem>, QueueItemGreater> queue;
+
+		size_t settled_count = 0;
+
+		weights[from] = ZERO_WEIGHT;
+		queue.push({ ZERO_WEIGHT, from });
+		while (!queue.empty()) {
+			const auto [weight, vertex] = queue.top();
+			queue.pop();
+			// устаревшая запись: вершина уже достигнута более коротким путём
+			if (*weights[vertex] < weight) {
+				continue;
+			}
+			++settled_count;
+			if (is_target[vertex]) {
+				is_target[vertex] = false;
+				if (--targets_left == 0) {
+					break;
+				}
+			}
+			for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+				const auto& edge = graph_.GetArc(edge_id);
+				const Weight candidate_weight = weight + edge.weight;
+				auto& weight_to = weights[edge.to];
+				if (!weight_to || candidate_weight < *weight_to) {
+					weight_to = candidate_weight;
+					prev_edges[edge.to] = edge_id;
+					queue.push({ candidate_weight, edge.to });
+				}
+			}
+		}
+		++query_count_;
+		settled_count_ += settled_count;
+	}
+
+	template <typename Weight>
+	std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+		VertexId to) const {
+		CheckVertex(from);
+		const size_t vertex_count = graph_.GetVertexCount();
+		// кратчайшие расстояния и последние рёбра найденных путей
+		std::vector<std::optional<Weight>> weights(vertex_count);
+		std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+		Sweep(from, { to }, weights, prev_edges);
+
+		if (!weights[to]) {
+			return std::nullopt;
+		}
+		std::vector<EdgeId> edges;
+		for (std::optional<EdgeId> edge_id = prev_edges[to];
+			edge_id;
+			edge_id = prev_edges[graph_.GetEdge(*edge_id).from])
+		{
+			edges.push_back(*edge_id);
+		}
+		std::reverse(edges.begin(), edges.end());
+
+		return RouteInfo{ *weights[to], std::move(edges) };
+	}
+
+	template <typename Weight>
+	std::optional<Weight> DijkstraRouter<Weight>::BuildRouteWeight(VertexId from, VertexId to) const {
+		CheckVertex(from);
+		const size_t vertex_count = graph_.GetVertexCount();
+		std::vector<std::optional<Weight>> weights(vertex_count);
+		std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+		Sweep(from, { to }, weights, prev_edges);
+		return weights[to];
+	}
+
+	template <typename Weight>
+	std::vector<std::vector<std::optional<Weight>>> DijkstraRouter<Weight>::BuildWeightMatrix(
+		const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+		const size_t vertex_count = graph_.GetVertexCount();
+		std::vector<std::vector<std::optional<Weight>>> result;
+		result.reserve(sources.size());
+		std::vector<std::optional<Weight>> weights;
+		std::vector<std::optional<EdgeId>> prev_edges;
+		for (const VertexId from : sources) {
+			CheckVertex(from);
+			if (targets.empty()) {
+				result.emplace_back();
+				continue;
+			}
+			weights.assign(vertex_count, std::nullopt);
+			prev_edges.assign(vertex_count, std::nullopt);
+			Sweep(from, targets, weights, prev_edges);
+			auto& row = result.emplace_back();
+			row.reserve(targets.size());
+			for (const VertexId to : targets) {
+				row.push_back(weights[to]);
+			}
+		}
+		return result;
+	}
+
+	template <typename Weight>
+	typename DijkstraRouter<Weight>::ShortestPathTree DijkstraRouter<Weight>::BuildShortestPathTree(VertexId from) const {
+		CheckVertex(from);
+		const size_t vertex_count = graph_.GetVertexCount();
+		std::vector<std::optional<Weight>> weights(vertex_count);
+		std::vector<std::optional<EdgeId>> prev_edges(vertex_count);
+		// без целей поиск не останавливается, пока не просмотрит все достижимые вершины
+		Sweep(from, {}, weights, prev_edges);
+
+		ShortestPathTree tree{ from, std::vector<Weight>(vertex_count, ZERO_WEIGHT), std::vector<EdgeId>(vertex_count, NO_EDGE) };
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			if (weights[vertex]) {
+				tree.weights[vertex] = *weights[vertex];
+			}
+			if (prev_edges[vertex]) {
+				tree.prev_edges[vertex] = *prev_edges[vertex];
+			}
+		}
+		return tree;
+	}
+
+	template <typename Weight>
+	std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(
+		const ShortestPathTree& tree, VertexId to) const {
+		CheckVertex(to);
+		if (!tree.IsReachable(to)) {
+			return std::nullopt;
+		}
+		std::vector<EdgeId> edges;
+		for (EdgeId edge_id = tree.prev_edges[to]; edge_id != NO_EDGE;
+			edge_id = tree.prev_edges[graph_.GetEdge(edge_id).from]) {
+			edges.push_back(edge_id);
+		}
+		std::reverse(edges.begin(), edges.end());
+		return RouteInfo{ tree.weights[to], std::move(edges) };
+	}
+
+	template <typename Weight>
+	std::vector<std::pair<VertexId, Weight>> DijkstraRouter<Weight>::FindReachable(VertexId from,
+		Weight max_weight) const {
+		CheckVertex(from);
+		std::vector<std::pair<VertexId, Weight>> reached;
+		if (max_weight < ZERO_WEIGHT) {
+			return reached;
+		}
+		std::unordered_map<VertexId, Weight> weights;
+		std::priority_queue<QueueItem, std::vector<QueueItem>, QueueItemGreater> queue;
+
+		weights[from] = ZERO_WEIGHT;
+		queue.push({ ZERO_WEIGHT, from });
+		while (!queue.empty()) {
+			const auto [weight, vertex] = queue.top();
+			queue.pop();
+			if (weights.at(vertex) < weight) {
+				continue;
+			}
+			reached.emplace_back(vertex, weight);
+			for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+				const auto& edge = graph_.GetArc(edge_id);
+				const Weight candidate_weight = weight + edge.weight;
+				if (max_weight < candidate_weight) {
+					continue;
+				}
+				const auto [it, inserted] = weights.emplace(edge.to, candidate_weight);
+				if (inserted || candidate_weight < it->second) {
+					it->second = candidate_weight;
+					queue.push({ candidate_weight, edge.to });
+				}
+			}
+		}
+		++query_count_;
+		settled_count_ += reached.size();
+		return reached;
+	}
+
+	template <typename Weight>
+	SearchStats DijkstraRouter<Weight>::GetSearchStats() const {
+		return { query_count_.load(), settled_count_.load() };
+	}
+}  // namespace graph
@@ -14,22 +14,23 @@
  */
 
 namespace domain {
-	bool PointerStopDataCompare::operator()(const StopData* lhs, const StopData* rhs) const {
-		return lhs->name == rhs->name;
+	StopData::StopData(std::pmr::memory_resource* resource)
+		: name(resource) {
 	}
 
-	bool PointerStopDataCompareLow::operator()(const StopData* lhs, const StopData* rhs) const {
-		return lhs->name < rhs->name;
+	RouteData::RouteData(std::pmr::memory_resource* resource)
+		: stops_(resource)
+		, unique_stops(resource)
+		, name(resource) {
 	}
 
-	size_t PointerStopDataHasher::operator()(const StopData* stop_data) const {
-		size_t result = 0;
-		size_t multiply = 1;
-		for (const auto& letter : stop_data->name) {
-			result += static_cast<size_t>(letter - 'A') * multiply;
-			multiply *= 100;
-		}
-		return result;
+	StopDataRoutes::StopDataRoutes(std::pmr::memory_resource* resource)
+		: StopData(resource)
+		, routes_(resource) {
+	}
+
+	bool PointerStopDataCompareLow::operator()(const StopData* lhs, const StopData* rhs) const {
+		return lhs->name < rhs->name;
 	}
 
 	size_t RouteDataHasher::operator()(const RouteData& route_data) const {
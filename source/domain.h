@@ -1,13 +1,16 @@
 #pragma once
 
 #include "geo.h"
+#include <cstdint>
 #include <string>
 #include <deque>
 #include <list>
+#include <memory_resource>
 #include <unordered_set>
 #include <unordered_map>
 #include <set>
 #include <string>
+#include <vector>
 
 /*
  * В этом файле вы можете разместить классы/структуры, которые являются частью предметной области (domain)
@@ -23,25 +26,25 @@
 namespace domain {
 
 	struct RouteData;
-	struct PointerStopDataHasher;
+
+	/// @brief id остановки: номер в порядке добавления в справочник (0, 1, 2, ...)
+	using StopId = uint32_t;
+	/// @brief id маршрута: номер в порядке добавления в справочник (0, 1, 2, ...)
+	using RouteId = uint32_t;
 
 	/// @brief автобусная остановка
+	/// @details Имя и контейнеры остановки размещаются в заданном ресурсе памяти (по умолчанию - в куче);
+	/// справочник размещает свои остановки в арене
 	struct StopData {
+		StopData() = default;
+		explicit StopData(std::pmr::memory_resource* resource);
+
 		/// @brief координаы данной остановки
 		geo::Coordinates coordinates;
 		/// @brief имя остановки
-		std::string name;
-		/// @brief расстояния до остановок
-		//std::unordered_map<const StopData*, int, PointerStopDataHasher> lengths_to_stops;
-		std::unordered_map<std::string_view, int> lengths_to_stops;
-	};
-
-	/// @brief компаратор для сравнения двух остановок 
-	/// @param lhs указатель на остановку
-	/// @param rhs указатель на остановку
-	/// @return результат сравнения имён остановок
-	struct PointerStopDataCompare {
-		bool operator()(const StopData* lhs, const StopData* rhs) const;
+		std::pmr::string name;
+		/// @brief id остановки (назначается справочником)
+		StopId id = 0;
 	};
 
 	/// @brief компаратор для сравнения двух остановок (set)
@@ -52,26 +55,25 @@ namespace domain {
 		bool operator()(const StopData* lhs, const StopData* rhs) const;
 	};
 
-	/// @brief хеш-функция для расчёта хеша указателя на структуру остановки StopData
-	/// @param stop_data остановка
-	/// @return хеш
-	struct PointerStopDataHasher {
-		size_t operator()(const StopData* stop_data) const;
-	};
-
 
 	/// @brief Маршрут
+	/// @details Номер и контейнеры маршрута размещаются в заданном ресурсе памяти (по умолчанию - в куче)
 	struct RouteData {
+		RouteData() = default;
+		explicit RouteData(std::pmr::memory_resource* resource);
+
 		/// @brief автобусные остановки
-		std::deque<const StopData*> stops_;
-		/// @brief уникальные автобусные остановки
-		std::unordered_set<const StopData*, PointerStopDataHasher, PointerStopDataCompare> unique_stops;
+		std::pmr::vector<const StopData*> stops_;
+		/// @brief id уникальных автобусных остановок
+		std::pmr::unordered_set<StopId> unique_stops;
 		/// @brief число уникальных автобусных остановок маршрута
 		size_t unique_stops_count;
 		/// @brief число автобусных остановок маршрута
 		size_t stops_count;
 		/// @brief номер маршруты
-		std::string name;
+		std::pmr::string name;
+		/// @brief id маршрута (назначается справочником)
+		RouteId id = 0;
 		/// @brief длина маршрута
 		double length_straight = 0;
 		/// @brief длина маршрута
@@ -115,10 +117,13 @@ namespace domain {
 
 	/// @brief автобусная остановка вместе с маршрутами, проходящими через неё
 	struct StopDataRoutes : StopData {
+		StopDataRoutes() = default;
+		explicit StopDataRoutes(std::pmr::memory_resource* resource);
+
 		/// @brief координаты и имя автобусной остановки
 		//StopData stop_data;
 		/// @brief маршруты в которых присутствует данная остановка
-		std::set<const RouteData*, PointerRouteDataCompareLow> routes_;
+		std::pmr::set<const RouteData*, PointerRouteDataCompareLow> routes_;
 	};
 
 	/// @brief типы команд
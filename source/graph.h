@@ -2,6 +2,7 @@
 
 #include "ranges.h"
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -16,44 +17,160 @@ namespace graph {
 		Weight weight;
 	};
 
+	/// @brief упакованное ребро в CSR-представлении графа: начало ребра задаётся смещением вершины
+	template <typename Weight>
+	struct Arc {
+		VertexId to;
+		Weight weight;
+	};
+
 	/// @brief класс, реализующий взвешенный ориентированный граф
+	/// @details Граф строится вызовами AddEdge, после чего «замораживается» методом Freeze в
+	/// CSR-представление (compressed sparse row): рёбра упорядочиваются по начальной вершине, исходящие
+	/// рёбра каждой вершины лежат в памяти подряд. Маршрутизаторы работают только с замороженным графом.
+	/// Для дополнения графа его можно «разморозить» (Unfreeze), добавить вершины и рёбра и заморозить снова
 	template <typename Weight>
 	class DirectedWeightedGraph {
 	private:
-		using IncidenceList = std::vector<EdgeId>;
-		using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+		using IncidentEdgesRange = ranges::Range<ranges::IndexIterator<EdgeId>>;
 
 	public:
 		DirectedWeightedGraph() = default;
 		explicit DirectedWeightedGraph(size_t vertex_count);
+
+		/// @brief Добавление вершин (только в незамороженный граф)
+		/// @return id первой добавленной вершины
+		VertexId AddVertices(size_t count);
 		EdgeId AddEdge(const Edge<Weight>& edge);
 
+		/// @brief Добавление count рёбер, заполняемых затем методом SetEdge (только в незамороженный граф)
+		/// @details Позволяет заполнять непересекающиеся диапазоны рёбер из разных потоков
+		/// @return id первого добавленного ребра
+		EdgeId AddEdges(size_t count);
+
+		/// @brief Замена ребра, добавленного в незамороженный граф
+		void SetEdge(EdgeId edge_id, const Edge<Weight>& edge);
+
+		/// @brief Перевод графа в CSR-представление
+		/// @details Рёбра сортируются по начальной вершине (с сохранением порядка добавления) и
+		/// перенумеровываются так, что id ребра совпадает с его позицией в CSR-массиве
+		/// @return новые id рёбер, индексированные id, которые вернул AddEdge
+		std::vector<EdgeId> Freeze();
+
+		/// @brief Возврат из CSR-представления для добавления вершин и рёбер
+		/// @details Рёбра сохраняют id, полученные при заморозке; новые рёбра получают следующие id
+		void Unfreeze();
+		bool IsFrozen() const;
+
 		size_t GetVertexCount() const;
 		size_t GetEdgeCount() const;
 		const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+
+		/// @brief Упакованное ребро по id (без проверки границ, для горячих циклов)
+		const Arc<Weight>& GetArc(EdgeId edge_id) const;
+
+		/// @brief Исходящие из вершины рёбра: непрерывный интервал id (только для замороженного графа)
 		IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
 	private:
+		size_t vertex_count_ = 0;
 		std::vector<Edge<Weight>> edges_;
-		std::vector<IncidenceList> incidence_lists_;
+		// смещения исходящих рёбер вершин в arcs_, размер vertex_count_ + 1
+		std::vector<EdgeId> offsets_;
+		std::vector<Arc<Weight>> arcs_;
 	};
 
 	template <typename Weight>
 	DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-		: incidence_lists_(vertex_count) {
+		: vertex_count_(vertex_count) {
+	}
+
+	template <typename Weight>
+	VertexId DirectedWeightedGraph<Weight>::AddVertices(size_t count) {
+		if (IsFrozen()) {
+			throw std::logic_error("Can't add vertices to a frozen graph");
+		}
+		vertex_count_ += count;
+		return vertex_count_ - count;
 	}
 
 	template <typename Weight>
 	EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+		if (IsFrozen()) {
+			throw std::logic_error("Can't add an edge to a frozen graph");
+		}
+		if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+			throw std::out_of_range("Edge's vertex id is out of range");
+		}
 		edges_.push_back(edge);
-		const EdgeId id = edges_.size() - 1;
-		incidence_lists_.at(edge.from).push_back(id);
-		return id;
+		return edges_.size() - 1;
+	}
+
+	template <typename Weight>
+	EdgeId DirectedWeightedGraph<Weight>::AddEdges(size_t count) {
+		if (IsFrozen()) {
+			throw std::logic_error("Can't add an edge to a frozen graph");
+		}
+		edges_.resize(edges_.size() + count, Edge<Weight>{ 0, 0, Weight{} });
+		return edges_.size() - count;
+	}
+
+	template <typename Weight>
+	void DirectedWeightedGraph<Weight>::SetEdge(EdgeId edge_id, const Edge<Weight>& edge) {
+		if (IsFrozen()) {
+			throw std::logic_error("Can't change an edge of a frozen graph");
+		}
+		if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+			throw std::out_of_range("Edge's vertex id is out of range");
+		}
+		edges_.at(edge_id) = edge;
+	}
+
+	template <typename Weight>
+	std::vector<EdgeId> DirectedWeightedGraph<Weight>::Freeze() {
+		if (IsFrozen()) {
+			throw std::logic_error("Graph is already frozen");
+		}
+		// сортировка подсчётом по начальной вершине
+		offsets_.assign(vertex_count_ + 1, 0);
+		for (const auto& edge : edges_) {
+			++offsets_[edge.from + 1];
+		}
+		for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+			offsets_[vertex + 1] += offsets_[vertex];
+		}
+		std::vector<EdgeId> new_ids(edges_.size());
+		std::vector<EdgeId> positions(offsets_.begin(), offsets_.end() - 1);
+		for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+			new_ids[edge_id] = positions[edges_[edge_id].from]++;
+		}
+
+		std::vector<Edge<Weight>> sorted_edges(edges_.size());
+		for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+			sorted_edges[new_ids[edge_id]] = edges_[edge_id];
+		}
+		edges_ = std::move(sorted_edges);
+		arcs_.reserve(edges_.size());
+		for (const auto& edge : edges_) {
+			arcs_.push_back({ edge.to, edge.weight });
+		}
+		return new_ids;
+	}
+
+	template <typename Weight>
+	void DirectedWeightedGraph<Weight>::Unfreeze() {
+		offsets_.clear();
+		arcs_.clear();
+	}
+
+	template <typename Weight>
+	bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+		return !offsets_.empty();
 	}
 
 	template <typename Weight>
 	size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-		return incidence_lists_.size();
+		return vertex_count_;
 	}
 
 	template <typename Weight>
@@ -66,9 +183,17 @@ namespace graph {
 		return edges_.at(edge_id);
 	}
 
+	template <typename Weight>
+	const Arc<Weight>& DirectedWeightedGraph<Weight>::GetArc(EdgeId edge_id) const {
+		return arcs_[edge_id];
+	}
+
 	template <typename Weight>
 	typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 		DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-		return ranges::AsRange(incidence_lists_.at(vertex));
+		if (!IsFrozen()) {
+			throw std::logic_error("Graph should be frozen before traversal");
+		}
+		return ranges::AsIndexRange(offsets_.at(vertex), offsets_.at(vertex + 1));
 	}
 }  // namespace graph
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+#include "contraction_hierarchy_router.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+	/// @brief статистика размеров меток
+	struct HubLabelStats {
+		size_t vertex_count = 0;
+		// суммарное число записей в прямых (исходящих) и обратных (входящих) метках
+		size_t forward_entries = 0;
+		size_t backward_entries = 0;
+		// наибольшее число записей в одной метке
+		size_t max_label_size = 0;
+		// среднее число записей в метке
+		double average_label_size = 0.0;
+		// память, занимаемая метками, байт
+		size_t memory_bytes = 0;
+	};
+
+	/// @brief Маршрутизатор на основе меток хабов (2-hop cover)
+	/// @details У каждой вершины есть прямая метка - хабы, достижимые из неё, и обратная - хабы, из которых
+	/// достижима она, с расстояниями. Для любой пары вершин общий хаб их меток лежит на кратчайшем пути,
+	/// поэтому запрос - слияние двух отсортированных по id хаба массивов. Метки строятся как пространства
+	/// поиска вверх по иерархии сжатия (поиски из разных вершин независимы и выполняются параллельно);
+	/// каждая запись помнит ребро иерархии, по которому достигнут хаб, что позволяет восстановить путь
+	template <typename Weight>
+	class HubLabelRouter : public RouterBase<Weight> {
+	private:
+		using Graph = DirectedWeightedGraph<Weight>;
+		using Hierarchy = ContractionHierarchyRouter<Weight>;
+
+	public:
+		using typename RouterBase<Weight>::RouteInfo;
+
+		/// @brief результат запроса по меткам
+		struct HubQueryResult {
+			Weight weight;
+			// хаб, через который проходит кратчайший путь
+			VertexId hub;
+		};
+
+		/// @param graph замороженный граф с неотрицательными весами рёбер
+		/// @param thread_count число потоков для построения меток (0 - по числу ядер)
+		explicit HubLabelRouter(const Graph& graph, size_t thread_count = 1);
+
+		/// @brief Вес кратчайшего пути и хаб на нём, без восстановления пути
+		/// @return std::nullopt, если пути нет
+		std::optional<HubQueryResult> Query(VertexId from, VertexId to) const;
+
+		std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+		/// @brief Вес пути - результат слияния меток, путь не восстанавливается
+		std::optional<Weight> BuildRouteWeight(VertexId from, VertexId to) const override;
+
+		/// @brief Слияние меток для каждой пары источник-цель
+		std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+			const std::vector<VertexId>& targets) const override;
+
+		HubLabelStats GetLabelStats() const;
+
+	private:
+		/// @brief запись метки
+		struct LabelEntry {
+			VertexId hub;
+			Weight weight;
+		};
+
+		/// @brief метки всех вершин одного направления в CSR-представлении
+		/// @details Записи метки вершины v занимают [offsets[v], offsets[v + 1]) и отсортированы по id хаба
+		struct Labels {
+			std::vector<size_t> offsets;
+			std::vector<LabelEntry> entries;
+			// рёбра иерархии, по которым достигнуты хабы (параллельно entries)
+			std::vector<EdgeId> parent_edges;
+
+			/// @brief Позиция записи хаба в метке вершины
+			size_t Find(VertexId vertex, VertexId hub) const;
+		};
+
+		/// @brief Построение меток одного направления
+		void BuildLabels(bool forward, parallel::ThreadPool& thread_pool, Labels& labels) const;
+
+		void CheckVertex(VertexId vertex) const {
+			if (vertex >= graph_.GetVertexCount()) {
+				throw std::out_of_range("Vertex id is out of range");
+			}
+		}
+
+		static constexpr Weight ZERO_WEIGHT{};
+		const Graph& graph_;
+		// иерархия нужна и после построения: для разворачивания рёбер найденного пути
+		Hierarchy hierarchy_;
+		// прямые метки: хабы, достижимые из вершины
+		Labels forward_labels_;
+		// обратные метки: хабы, из которых достижима вершина
+		Labels backward_labels_;
+	};
+
+	template <typename Weight>
+	HubLabelRouter<Weight>::HubLabelRouter(const Graph& graph, size_t thread_count)
+		: graph_(graph)
+		, hierarchy_(graph)
+	{
+		parallel::ThreadPool thread_pool(thread_count);
+		BuildLabels(true, thread_pool, forward_labels_);
+		BuildLabels(false, thread_pool, backward_labels_);
+	}
+
+	template <typename Weight>
+	void HubLabelRouter<Weight>::BuildLabels(bool forward, parallel::ThreadPool& thread_pool, Labels& labels) const {
+		const size_t vertex_count = graph_.GetVertexCount();
+		std::vector<std::vector<typename Hierarchy::SearchSpaceEntry>> search_spaces(vertex_count);
+		// вершины делятся на части, у каждой части свои рабочие массивы поиска
+		const size_t chunk_count = std::min(vertex_count, thread_pool.GetThreadCount() * 4);
+		thread_pool.ParallelFor(chunk_count, [this, forward, vertex_count, chunk_count, &search_spaces](size_t chunk) {
+			typename Hierarchy::UpwardSearchWorkspace workspace(vertex_count);
+			for (VertexId vertex = chunk; vertex < vertex_count; vertex += chunk_count) {
+				auto& search_space = search_spaces[vertex];
+				search_space = hierarchy_.GetUpwardSearchSpace(vertex, forward, workspace);
+				std::sort(search_space.begin(), search_space.end(), [](const auto& lhs, const auto& rhs) {
+					return lhs.vertex < rhs.vertex;
+				});
+			}
+		});
+
+		labels.offsets.assign(vertex_count + 1, 0);
+		for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+			labels.offsets[vertex + 1] = labels.offsets[vertex] + search_spaces[vertex].size();
+		}
+		labels.entries.resize(labels.offsets.back());
+		labels.parent_edges.resize(labels.offsets.back());
+		thread_pool.ParallelFor(chunk_count, [vertex_count, chunk_count, &search_spaces, &labels](size_t chunk) {
+			for (VertexId vertex = chunk; vertex < vertex_count; vertex += chunk_count) {
+				size_t position = labels.offsets[vertex];
+				for (const auto& entry : search_spaces[vertex]) {
+					labels.entries[position] = { entry.vertex, entry.weight };
+					labels.parent_edges[position] = entry.parent_edge;
+					++position;
+				}
+				search_spaces[vertex] = {};
+			}
+		});
+	}
+
+	template <typename Weight>
+	size_t HubLabelRouter<Weight>::Labels::Find(VertexId vertex, VertexId hub) const {
+		const auto begin = entries.begin() + offsets[vertex];
+		const auto end = entries.begin() + offsets[vertex + 1];
+		const auto it = std::lower_bound(begin, end, hub, [](const LabelEntry& entry, VertexId value) {
+			return entry.hub < value;
+		});
+		if (it == end || it->hub != hub) {
+			throw std::logic_error("Hub is missing from the label");
+		}
+		return static_cast<size_t>(it - entries.begin());
+	}
+
+	template <typename Weight>
+	std::optional<typename HubLabelRouter<Weight>::HubQueryResult> HubLabelRouter<Weight>::Query(VertexId from,
+		VertexId to) const {
+		CheckVertex(from);
+		CheckVertex(to);
+		const LabelEntry* forward_it = forward_labels_.entries.data() + forward_labels_.offsets[from];
+		const LabelEntry* const forward_end = forward_labels_.entries.data() + forward_labels_.offsets[from + 1];
+		const LabelEntry* backward_it = backward_labels_.entries.data() + backward_labels_.offsets[to];
+		const LabelEntry* const backward_end = backward_labels_.entries.data() + backward_labels_.offsets[to + 1];
+
+		std::optional<HubQueryResult> result;
+		while (forward_it != forward_end && backward_it != backward_end) {
+			if (forward_it->hub < backward_it->hub) {
+				++forward_it;
+			}
+			else if (backward_it->hub < forward_it->hub) {
+				++backward_it;
+			}
+			else {
+				const Weight weight = forward_it->weight + backward_it->weight;
+				if (!result || weight < result->weight) {
+					result = HubQueryResult{ weight, forward_it->hub };
+				}
+				++forward_it;
+				++backward_it;
+			}
+		}
+		return result;
+	}
+
+	template <typename Weight>
+	std::optional<typename HubLabelRouter<Weight>::RouteInfo> HubLabelRouter<Weight>::BuildRoute(VertexId from,
+		VertexId to) const {
+		const auto query_result = Query(from, to);
+		if (!query_result) {
+			return std::nullopt;
+		}
+		// рёбра иерархии от начала до хаба: по записям прямой метки начальной вершины
+		std::vector<EdgeId> hierarchy_edges;
+		for (size_t position = forward_labels_.Find(from, query_result->hub);
+			forward_labels_.parent_edges[position] != Hierarchy::NO_EDGE;) {
+			const EdgeId edge_id = forward_labels_.parent_edges[position];
+			hierarchy_edges.push_back(edge_id);
+			position = forward_labels_.Find(from, hierarchy_.GetHierarchyEdge(edge_id).from);
+		}
+		std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+		// от хаба до конца: по записям обратной метки конечной вершины
+		for (size_t position = backward_labels_.Find(to, query_result->hub);
+			backward_labels_.parent_edges[position] != Hierarchy::NO_EDGE;) {
+			const EdgeId edge_id = backward_labels_.parent_edges[position];
+			hierarchy_edges.push_back(edge_id);
+			position = backward_labels_.Find(to, hierarchy_.GetHierarchyEdge(edge_id).to);
+		}
+
+		std::vector<EdgeId> edges;
+		for (const EdgeId edge_id : hierarchy_edges) {
+			hierarchy_.UnpackEdge(edge_id, edges);
+		}
+		// вес пересчитывается по исходным рёбрам в порядке пути, как при поиске Дейкстрой
+		Weight weight = ZERO_WEIGHT;
+		for (const EdgeId edge_id : edges) {
+			weight = weight + graph_.GetArc(edge_id).weight;
+		}
+		return RouteInfo{ weight, std::move(edges) };
+	}
+
+	template <typename Weight>
+	std::optional<Weight> HubLabelRouter<Weight>::BuildRouteWeight(VertexId from, VertexId to) const {
+		if (const auto query_result = Query(from, to)) {
+			return query_result->weight;
+		}
+		return std::nullopt;
+	}
+
+	template <typename Weight>
+	std::vector<std::vector<std::optional<Weight>>> HubLabelRouter<Weight>::BuildWeightMatrix(
+		const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+		std::vector<std::vector<std::optional<Weight>>> result(sources.size(),
+			std::vector<std::optional<Weight>>(targets.size()));
+		for (size_t i = 0; i < sources.size(); ++i) {
+			for (size_t j = 0; j < targets.size(); ++j) {
+				if (const auto query_result = Query(sources[i], targets[j])) {
+					result[i][j] = query_result->weight;
+				}
+			}
+		}
+		return result;
+	}
+
+	template <typename Weight>
+	HubLabelStats HubLabelRouter<Weight>::GetLabelStats() const {
+		HubLabelStats stats;
+		stats.vertex_count = graph_.GetVertexCount();
+		stats.forward_entries = forward_labels_.entries.size();
+		stats.backward_entries = backward_labels_.entries.size();
+		for (const Labels* labels : { &forward_labels_, &backward_labels_ }) {
+			for (VertexId vertex = 0; vertex < stats.vertex_count; ++vertex) {
+				stats.max_label_size = std::max(stats.max_label_size, labels->offsets[vertex + 1] - labels->offsets[vertex]);
+			}
+			stats.memory_bytes += labels->offsets.size() * sizeof(size_t)
+				+ labels->entries.size() * (sizeof(LabelEntry) + sizeof(EdgeId));
+		}
+		if (stats.vertex_count > 0) {
+			stats.average_label_size = static_cast<double>(stats.forward_entries + stats.backward_entries)
+				/ static_cast<double>(2 * stats.vertex_count);
+		}
+		return stats;
+	}
+}  // namespace graph
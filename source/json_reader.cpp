@@ -1,5 +1,13 @@
 #include "json_reader.h"
 
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 /*
  * Здесь можно разместить код наполнения транспортного справочника данными из JSON,
  * а также код обработки запросов к базе и формирование массива ответов в формате JSON
@@ -7,7 +15,7 @@
 
 JsonReader::JsonReader(const json::Document& doc) :
 	doc_(doc),
-	request_handler() {}
+	request_handler(std::make_shared<request_handler::RequestHandler>()) {}
 
 void JsonReader::ProcessInputStopRequest(std::list<size_t>& route_requests_ids, std::list<size_t>& stop_requests_ids) {
 	const json::Node& input_requests = doc_.GetRoot().AsDict().at("base_requests").AsArray();
@@ -22,15 +30,11 @@ void JsonReader::ProcessInputStopRequest(std::list<size_t>& route_requests_ids,
 		else if (request_map.at("type").AsString() == "Stop") {
 			stop_requests_ids.push_back(id);
 			domain::StopDataRoutes stop;
-			std::string stop_name(request_map.at("name").AsString());
-			// вызов данного метода пугает компилятор и тот отключает SSO (оптимизацию коротких строк)
-			// при коротких строках, вызывался memcpy заместо swap укзателей.
-			stop_name.reserve(sizeof(stop_name) + 1);
-			stop.name = std::move(stop_name);
+			stop.name = request_map.at("name").AsString();
 			stop.coordinates.lat = request_map.at("latitude").AsDouble();
 			stop.coordinates.lng = request_map.at("longitude").AsDouble();
 			// запись в транспортный справочник остановки
-			request_handler.AddStopInTransportCatalogue(std::move(stop));
+			request_handler->AddStopInTransportCatalogue(std::move(stop));
 		}
 		++id;
 	}
@@ -44,7 +48,7 @@ void JsonReader::ProcessInputStopsLengthsRequest(const std::list<size_t>& stop_r
 		std::string_view stop_a(request_map.at("name").AsString());
 		for (const auto& [stop, distance] : road_distances) {
 			std::string_view stop_b(stop);
-			request_handler.AddLengthBetweenStops(stop_a, stop_b, distance.AsInt());
+			request_handler->AddLengthBetweenStops(stop_a, stop_b, distance.AsInt());
 		}
 	}
 }
@@ -56,26 +60,27 @@ void JsonReader::ProcessInputRouteRequest(const std::list<size_t>& route_request
 		if (request_map.at("type").AsString() == "Bus") {
 			domain::RouteData route_data;
 			route_data.type = request_map.at("is_roundtrip").AsBool() == true ? domain::route_marks::CIRCLE : domain::route_marks::TO_AND_BACK;
-			auto route_name = request_map.at("name").AsString();
-			// вызов данного метода пугает компилятор и тот отключает SSO (оптимизацию коротких строк)
-			// при коротких строках, вызывался memcpy заместо swap укзателей.
-			route_name.reserve(sizeof(route_name) + 1);
-			route_data.name = std::move(route_name);
+			route_data.name = request_map.at("name").AsString();
 			const auto& stops_ = request_map.at("stops").AsArray();
+			// id остановок в порядке проезда: расстояния по дорогам запрашиваются одним пакетом
+			std::vector<domain::StopId> stop_ids;
+			stop_ids.reserve(stops_.size());
 			// добавление остановок в маршрут
 			for (const auto& stop_node : stops_) {
 				const auto& stop_name = stop_node.AsString();
-				const auto& stop = request_handler.GetStopStat(stop_name);
+				const auto& stop = request_handler->GetStopStat(stop_name);
 				if (stop == std::nullopt) {
 					continue;
 				}
-				auto it = route_data.stops_.insert(route_data.stops_.end(), *stop);
-				route_data.unique_stops.insert(*stop);
-				if (route_data.stops_.size() > 1) {
-					auto it_prev = std::next(it, -1);
-					route_data.length_straight += geo::ComputeDistance((*it_prev)->coordinates, (*it)->coordinates);
-					route_data.length += ((*it_prev)->lengths_to_stops.at((*it)->name));
+				if (!route_data.stops_.empty()) {
+					route_data.length_straight += geo::ComputeDistance(route_data.stops_.back()->coordinates, (*stop)->coordinates);
 				}
+				route_data.stops_.push_back(*stop);
+				route_data.unique_stops.insert((*stop)->id);
+				stop_ids.push_back((*stop)->id);
+			}
+			for (const int length : request_handler->GetLengthsBetweenStops(stop_ids)) {
+				route_data.length += length;
 			}
 			route_data.stops_count = route_data.stops_.size();
 			// вторая половина маршрута в обратном направление, если маршрут типа ТУДА-И-ОБРАТНО
@@ -86,15 +91,15 @@ void JsonReader::ProcessInputRouteRequest(const std::list<size_t>& route_request
 				route_data.stops_count *= 2;
 				// убираем остановку с которой начинаем обратный путь
 				--route_data.stops_count;
-				for (auto it = std::next(route_data.stops_.crbegin(), 1); it != route_data.stops_.rend(); std::advance(it, 1)) {
-					auto it_prev = std::next(it, -1);
-					route_data.length += ((*it_prev)->lengths_to_stops.at((*it)->name));
+				std::reverse(stop_ids.begin(), stop_ids.end());
+				for (const int length : request_handler->GetLengthsBetweenStops(stop_ids)) {
+					route_data.length += length;
 				}
 			}
 			route_data.curvature = route_data.length / route_data.length_straight;
 			route_data.unique_stops_count = route_data.unique_stops.size();
 			// Добавляем маршрут в справочник
-			request_handler.AddRouteInTransportCatalogue(std::move(route_data));
+			request_handler->AddRouteInTransportCatalogue(std::move(route_data));
 		}
 	}
 }
@@ -105,11 +110,75 @@ void JsonReader::ProcessTransportCatalogueInputData() {
 	ProcessInputStopRequest(route_requests_ids, stop_requests_ids);
 	ProcessInputStopsLengthsRequest(stop_requests_ids);
 	ProcessInputRouteRequest(route_requests_ids);
+	// справочник больше не меняется: запросы обслуживаются его снимком
+	request_handler->FreezeTransportCatalogue();
 }
 
-void JsonReader::ProcessRoutingSettings() {
+/// @brief обработка неотрицательной целочисленной настройки (числа потоков, размера кэша)
+/// @param setting значение настройки в json формате
+/// @param name имя настройки для сообщения об ошибке
+/// @return значение настройки
+/// @throws std::invalid_argument, если значение отрицательно
+size_t ProcessSizeSetting(const json::Node& setting, const std::string& name) {
+	const int value = setting.AsInt();
+	if (value < 0) {
+		throw std::invalid_argument("negative " + name + ": " + std::to_string(value));
+	}
+	return static_cast<size_t>(value);
+}
+
+TransportRouter::RoutingSettings JsonReader::ProcessRoutingSettingsData() {
+	TransportRouter::RoutingSettings result;
 	const json::Dict& routing_settings = doc_.GetRoot().AsDict().at("routing_settings").AsDict();
-	request_handler.InitTransportRouter(routing_settings.at("bus_wait_time").AsDouble(), routing_settings.at("bus_velocity").AsDouble());
+
+	result.bus_wait_time = routing_settings.at("bus_wait_time").AsDouble();
+	result.bus_velocity = routing_settings.at("bus_velocity").AsDouble();
+	// необязательная настройка: по умолчанию пути рассчитываются заранее
+	if (const auto it = routing_settings.find("router_type"); it != routing_settings.end()) {
+		const std::string& router_type = it->second.AsString();
+		if (router_type == "floyd_warshall") {
+			result.router_type = TransportRouter::RouterType::FLOYD_WARSHALL;
+		}
+		else if (router_type == "dijkstra") {
+			result.router_type = TransportRouter::RouterType::DIJKSTRA;
+		}
+		else if (router_type == "contraction_hierarchy") {
+			result.router_type = TransportRouter::RouterType::CONTRACTION_HIERARCHY;
+		}
+		else if (router_type == "a_star") {
+			result.router_type = TransportRouter::RouterType::A_STAR;
+		}
+		else if (router_type == "bidirectional_a_star") {
+			result.router_type = TransportRouter::RouterType::BIDIRECTIONAL_A_STAR;
+		}
+		else if (router_type == "hub_labels") {
+			result.router_type = TransportRouter::RouterType::HUB_LABELS;
+		}
+		else {
+			throw std::invalid_argument("unknown router_type: " + router_type);
+		}
+	}
+	if (const auto it = routing_settings.find("thread_count"); it != routing_settings.end()) {
+		result.thread_count = ProcessSizeSetting(it->second, it->first);
+	}
+	if (const auto it = routing_settings.find("route_cache_size"); it != routing_settings.end()) {
+		result.route_cache_size = ProcessSizeSetting(it->second, it->first);
+	}
+	if (const auto it = routing_settings.find("index_file"); it != routing_settings.end()) {
+		result.index_file = it->second.AsString();
+	}
+	if (const auto it = routing_settings.find("path_tree_cache_mb"); it != routing_settings.end()) {
+		result.path_tree_cache_mb = ProcessSizeSetting(it->second, it->first);
+	}
+	if (const auto it = routing_settings.find("contract_chains"); it != routing_settings.end()) {
+		result.contract_chains = it->second.AsBool();
+	}
+
+	return result;
+}
+
+void JsonReader::ProcessRoutingSettings() {
+	request_handler->InitTransportRouter(ProcessRoutingSettingsData());
 }
 
 /// @brief обработка цвета
@@ -170,8 +239,15 @@ map_renderer::RenderSettings JsonReader::ProcessRenderSettings() {
 
 void JsonReader::ProcessMapRendererInputData() {
 	// настройки визуализации карты
-	request_handler.SetRenderSettings(ProcessRenderSettings());
-	request_handler.PrepareSvgDoc();
+	request_handler->SetRenderSettings(ProcessRenderSettings());
+	request_handler->PrepareSvgDoc();
+}
+
+void JsonReader::ProcessAddedInputRequests() {
+	request_handler->UnfreezeTransportCatalogue();
+	ProcessTransportCatalogueInputData();
+	request_handler->UpdateTransportRouter();
+	ProcessMapRendererInputData();
 }
 
 void JsonReader::ProcessInputRequests() {
@@ -180,11 +256,12 @@ void JsonReader::ProcessInputRequests() {
 	ProcessRoutingSettings();
 }
 
-void JsonReader::ProcessBusStatRequest(json::Builder& node, const json::Dict& request) {
+void JsonReader::ProcessBusStatRequest(json::Builder& node, const json::Dict& request,
+	const request_handler::RequestHandler& handler) {
 	using namespace std::literals;
 	const auto& request_id = request.at("id"s).AsInt();
 	std::string name = request.at("name"s).AsString();
-	auto route_data = request_handler.GetBusStat(name);
+	auto route_data = handler.GetBusStat(name);
 	if (route_data != std::nullopt) {
 		json::Node value_node{ json::Builder{}.StartDict()
 				.Key("request_id"s).Value(request_id)
@@ -204,15 +281,16 @@ void JsonReader::ProcessBusStatRequest(json::Builder& node, const json::Dict& re
 	}
 }
 
-void JsonReader::ProcessStopStatRequest(json::Builder& node, const json::Dict& request) {
+void JsonReader::ProcessStopStatRequest(json::Builder& node, const json::Dict& request,
+	const request_handler::RequestHandler& handler) {
 	using namespace std::literals;
 	const auto& request_id = request.at("id"s).AsInt();
 	std::string name = request.at("name"s).AsString();
-	const auto& stop_data = request_handler.GetStopStat(name);
-	if (stop_data != std::nullopt) {
+	const auto stop_routes = handler.GetBusesByStop(name);
+	if (stop_routes != std::nullopt) {
 		json::Array routes;
-		for (const auto& route_data : **request_handler.GetBusesByStop((*stop_data)->name)) {
-			routes.push_back(route_data->name);
+		for (const domain::RouteData* route_data : *stop_routes) {
+			routes.push_back(std::string(route_data->name));
 		}
 		json::Node value_node{ json::Builder{}.StartDict()
 					.Key("request_id"s).Value(request_id)
@@ -229,20 +307,33 @@ void JsonReader::ProcessStopStatRequest(json::Builder& node, const json::Dict& r
 	}
 }
 
-void JsonReader::ProcessMapStatRequest(json::Builder& node, const json::Dict& request) {
+void JsonReader::ProcessMapStatRequest(json::Builder& node, const json::Dict& request,
+	const request_handler::RequestHandler& handler) {
 	using namespace std::literals;
 	const auto& request_id = request.at("id"s).AsInt();
 	json::Node value_node{ json::Builder{}.StartDict()
 				.Key("request_id"s).Value(request_id)
-				.Key("map"s).Value(request_handler.RenderMap())
+				.Key("map"s).Value(handler.RenderMap())
 				.EndDict().Build() };
 	node.Value(value_node);
 }
 
-void JsonReader::ProcessRouteStatRequest(json::Builder& node, const json::Dict& request) {
+void JsonReader::ProcessRouteStatRequest(json::Builder& node, const json::Dict& request,
+	const request_handler::RequestHandler& handler) {
 	using namespace std::literals;
+	// список полей ответа без "items": путь не восстанавливается, выводится только время
+	if (const auto fields_it = request.find("fields"s); fields_it != request.end()) {
+		const auto& fields = fields_it->second.AsArray();
+		const bool with_items = std::any_of(fields.begin(), fields.end(), [](const json::Node& field) {
+			return field.AsString() == "items"s;
+		});
+		if (!with_items) {
+			ProcessRouteTimeStatRequest(node, request, handler);
+			return;
+		}
+	}
 	const auto& request_id = request.at("id"s).AsInt();
-	auto route = request_handler.FindPath(request.at("from"s).AsString(), request.at("to"s).AsString());
+	auto route = handler.FindPath(request.at("from"s).AsString(), request.at("to"s).AsString());
 	if (route != std::nullopt) {
 		// задействованные маршруты в найденном пути
 		json::Array routes;
@@ -287,34 +378,302 @@ void JsonReader::ProcessRouteStatRequest(json::Builder& node, const json::Dict&
 	}
 }
 
+void JsonReader::ProcessRouteTimeStatRequest(json::Builder& node, const json::Dict& request,
+	const request_handler::RequestHandler& handler) {
+	using namespace std::literals;
+	const auto& request_id = request.at("id"s).AsInt();
+	const auto total_time = handler.FindTime(request.at("from"s).AsString(), request.at("to"s).AsString());
+	if (total_time != std::nullopt) {
+		json::Node value_node{ json::Builder{}.StartDict()
+					.Key("request_id"s).Value(request_id)
+					.Key("total_time"s).Value(*total_time)
+					.EndDict().Build() };
+		node.Value(value_node);
+	}
+	// пути между остановками нет
+	else {
+		json::Node value_node{ json::Builder{}.StartDict()
+					.Key("request_id"s).Value(request_id)
+					.Key("error_message"s).Value("not found"s)
+					.EndDict().Build() };
+		node.Value(value_node);
+	}
+}
+
+void JsonReader::ProcessMatrixStatRequest(json::Builder& node, const json::Dict& request,
+	const request_handler::RequestHandler& handler) {
+	using namespace std::literals;
+	const auto& request_id = request.at("id"s).AsInt();
+	auto to_stop_names = [](const json::Array& stops) {
+		std::vector<std::string> stop_names;
+		stop_names.reserve(stops.size());
+		for (const auto& stop : stops) {
+			stop_names.push_back(stop.AsString());
+		}
+		return stop_names;
+	};
+	const auto matrix = handler.FindTimeMatrix(to_stop_names(request.at("from"s).AsArray()),
+		to_stop_names(request.at("to"s).AsArray()));
+	if (matrix != std::nullopt) {
+		// строка матрицы на каждую остановку отправления, null - пути нет
+		json::Array rows;
+		rows.reserve(matrix->size());
+		for (const auto& matrix_row : *matrix) {
+			json::Array row;
+			row.reserve(matrix_row.size());
+			for (const auto& time : matrix_row) {
+				row.push_back(time ? json::Node{ *time } : json::Node{ nullptr });
+			}
+			rows.push_back(std::move(row));
+		}
+		json::Node value_node{ json::Builder{}.StartDict()
+					.Key("request_id"s).Value(request_id)
+					.Key("total_times"s).Value(rows)
+					.EndDict().Build() };
+		node.Value(value_node);
+	}
+	// какой-либо остановки нет в справочнике
+	else {
+		json::Node value_node{ json::Builder{}.StartDict()
+					.Key("request_id"s).Value(request_id)
+					.Key("error_message"s).Value("not found"s)
+					.EndDict().Build() };
+		node.Value(value_node);
+	}
+}
+
+void JsonReader::ProcessIsochroneStatRequest(json::Builder& node, const json::Dict& request,
+	const request_handler::RequestHandler& handler) {
+	using namespace std::literals;
+	const auto& request_id = request.at("id"s).AsInt();
+	const auto reachable_stops = handler.FindReachableStops(request.at("from"s).AsString(),
+		request.at("max_time"s).AsDouble());
+	if (reachable_stops != std::nullopt) {
+		json::Array stops;
+		stops.reserve(reachable_stops->size());
+		for (const auto& stop : *reachable_stops) {
+			json::Node stop_node{ json::Builder{}.StartDict()
+						.Key("stop_name"s).Value(std::string(stop.stop_name))
+						.Key("time"s).Value(stop.time)
+						.EndDict().Build() };
+			stops.push_back(std::move(stop_node));
+		}
+		json::Node value_node{ json::Builder{}.StartDict()
+					.Key("request_id"s).Value(request_id)
+					.Key("stops"s).Value(stops)
+					.EndDict().Build() };
+		node.Value(value_node);
+	}
+	// остановки нет в справочнике
+	else {
+		json::Node value_node{ json::Builder{}.StartDict()
+					.Key("request_id"s).Value(request_id)
+					.Key("error_message"s).Value("not found"s)
+					.EndDict().Build() };
+		node.Value(value_node);
+	}
+}
+
+/// @brief статистика кэша в json формате
+/// @param stats статистика кэша
+/// @return словарь с числом попаданий, промахов, вытеснений и долей попаданий
+json::Node ProcessCacheStats(const cache::CacheStats& stats) {
+	using namespace std::literals;
+	return json::Builder{}.StartDict()
+		.Key("hits"s).Value(static_cast<int>(stats.hits))
+		.Key("misses"s).Value(static_cast<int>(stats.misses))
+		.Key("evictions"s).Value(static_cast<int>(stats.evictions))
+		.Key("hit_rate"s).Value(stats.GetHitRate())
+		.EndDict().Build();
+}
+
+void JsonReader::ProcessRouterStatsRequest(json::Builder& node, const json::Dict& request,
+	const request_handler::RequestHandler& handler) {
+	using namespace std::literals;
+	const auto& request_id = request.at("id"s).AsInt();
+	const graph::SearchStats search_stats = handler.GetSearchStats();
+	json::Dict value{
+		{ "request_id"s, request_id },
+		{ "search"s, json::Builder{}.StartDict()
+			.Key("queries"s).Value(static_cast<int>(search_stats.queries))
+			.Key("settled_vertices"s).Value(static_cast<int>(search_stats.settled_vertices))
+			.EndDict().Build() },
+		{ "path_cache"s, ProcessCacheStats(handler.GetPathCacheStats()) },
+		{ "path_tree_cache"s, ProcessCacheStats(handler.GetPathTreeCacheStats()) },
+	};
+	// размеры меток выводятся только для алгоритма hub_labels
+	if (const auto hub_label_stats = handler.GetHubLabelStats()) {
+		value.emplace("hub_labels"s, json::Builder{}.StartDict()
+			.Key("vertex_count"s).Value(static_cast<int>(hub_label_stats->vertex_count))
+			.Key("forward_entries"s).Value(static_cast<int>(hub_label_stats->forward_entries))
+			.Key("backward_entries"s).Value(static_cast<int>(hub_label_stats->backward_entries))
+			.Key("max_label_size"s).Value(static_cast<int>(hub_label_stats->max_label_size))
+			.Key("average_label_size"s).Value(hub_label_stats->average_label_size)
+			.Key("memory_bytes"s).Value(static_cast<int>(hub_label_stats->memory_bytes))
+			.EndDict().Build());
+	}
+	node.Value(json::Node{ std::move(value) });
+}
+
 json::Document JsonReader::ProcessStatRequests() {
 	using namespace std::literals;
 	const auto& stat_requests = doc_.GetRoot().AsDict().at("stat_requests"s);
-	json::Builder node;
-	node.StartArray();
+	json::Array responses;
+	// обновления, не ждущие построения: номер ответа и результат построения
+	std::vector<std::pair<size_t, std::future<uint64_t>>> pending_updates;
 
 	for (const auto& stat_request : stat_requests.AsArray()) {
 		const auto& request = stat_request.AsDict();
 		const auto& type = request.at("type"s);
+		json::Builder node;
+		if (type == "Update"s) {
+			if (auto result = ProcessUpdateRequest(node, request); result.valid()) {
+				pending_updates.emplace_back(responses.size(), std::move(result));
+			}
+			responses.push_back(node.Build());
+			continue;
+		}
+		// запрос обслуживается от начала до конца одной версией, даже если тем временем опубликована новая
+		const auto version = versions_.Acquire();
+		const auto& handler = *version->handler;
 		if (type == "Bus"s) {
-			ProcessBusStatRequest(node, request);
+			ProcessBusStatRequest(node, request, handler);
 		}
 		else if (type == "Stop"s) {
-			ProcessStopStatRequest(node, request);
+			ProcessStopStatRequest(node, request, handler);
 		}
 		else if (type == "Map"s) {
-			ProcessMapStatRequest(node, request);
+			ProcessMapStatRequest(node, request, handler);
 		}
 		else if (type == "Route"s) {
-			ProcessRouteStatRequest(node, request);
+			ProcessRouteStatRequest(node, request, handler);
 		}
+		else if (type == "Matrix"s) {
+			ProcessMatrixStatRequest(node, request, handler);
+		}
+		else if (type == "Isochrone"s) {
+			ProcessIsochroneStatRequest(node, request, handler);
+		}
+		else if (type == "RouterStats"s) {
+			ProcessRouterStatsRequest(node, request, handler);
+		}
+		else {
+			continue;
+		}
+		responses.push_back(node.Build());
+	}
+	// ответы выводятся все вместе, поэтому ошибка построения попадает в ответ вызвавшего его обновления
+	for (auto& [response_id, result] : pending_updates) {
+		try {
+			result.get();
+		}
+		catch (const std::exception& e) {
+			json::Dict response = responses[response_id].AsDict();
+			response.emplace("error_message"s, std::string(e.what()));
+			responses[response_id] = json::Node{ std::move(response) };
+		}
+	}
+	return json::Document{ json::Node{ std::move(responses) } };
+}
+
+std::future<uint64_t> JsonReader::ProcessUpdateRequest(json::Builder& node, const json::Dict& request) {
+	using namespace std::literals;
+	const auto& request_id = request.at("id"s).AsInt();
+	auto result = versions_.BuildNext([this, update_requests = request.at("base_requests"s).AsArray()] {
+		return BuildUpdatedRequestHandler(update_requests);
+	});
+	json::Dict response{ { "request_id"s, json::Node{ request_id } } };
+	// по умолчанию запросы не ждут построения и обслуживаются текущей версией, пока не опубликована новая;
+	// если построение не удалось, запросы продолжает обслуживать текущая версия
+	if (const auto it = request.find("wait"s); it == request.end() || !it->second.AsBool()) {
+		response.emplace("version"s, json::Node{ static_cast<int>(versions_.GetVersionNumber()) });
+		node.Value(json::Node{ std::move(response) });
+		return result;
+	}
+	try {
+		response.emplace("version"s, json::Node{ static_cast<int>(result.get()) });
+	}
+	catch (const std::exception& e) {
+		response.emplace("version"s, json::Node{ static_cast<int>(versions_.GetVersionNumber()) });
+		response.emplace("error_message"s, json::Node{ std::string(e.what()) });
+	}
+	node.Value(json::Node{ std::move(response) });
+	return {};
+}
+
+std::shared_ptr<const request_handler::RequestHandler> JsonReader::BuildUpdatedRequestHandler(const json::Array& update_requests) {
+	using namespace std::literals;
+	// запрос обновления заменяет запрос того же типа с тем же именем (последний из одноимённых)
+	std::map<std::pair<std::string_view, std::string_view>, size_t> update_ids;
+	for (size_t id = 0; id < update_requests.size(); ++id) {
+		const auto& request_map = update_requests[id].AsDict();
+		update_ids[{ request_map.at("type"s).AsString(), request_map.at("name"s).AsString() }] = id;
+	}
+	json::Array base_requests = base_requests_ ? *base_requests_ : doc_.GetRoot().AsDict().at("base_requests"s).AsArray();
+	const size_t previous_request_count = base_requests.size();
+	bool only_additions = true;
+	for (auto& request : base_requests) {
+		const auto& request_map = request.AsDict();
+		const auto it = update_ids.find({ request_map.at("type"s).AsString(), request_map.at("name"s).AsString() });
+		if (it != update_ids.end()) {
+			request = update_requests[it->second];
+			update_ids.erase(it);
+			only_additions = false;
+		}
+	}
+	// новые остановки и маршруты добавляются в порядке запросов обновления
+	for (size_t id = 0; id < update_requests.size(); ++id) {
+		const auto& request_map = update_requests[id].AsDict();
+		const auto it = update_ids.find({ request_map.at("type"s).AsString(), request_map.at("name"s).AsString() });
+		if (it != update_ids.end() && it->second == id) {
+			base_requests.push_back(update_requests[id]);
+		}
+	}
+	// следующая версия строится с прежними настройками
+	json::Dict root;
+	for (const auto& [key, value] : doc_.GetRoot().AsDict()) {
+		if (key != "base_requests"s && key != "stat_requests"s) {
+			root.emplace(key, value);
+		}
+	}
+	std::shared_ptr<request_handler::RequestHandler> handler;
+	// предыдущую версию отпустили все читатели (флаг прочитан с acquire-семантикой), и с её построения
+	// запросы только добавлялись: новые остановки и маршруты получают следующие id, как и при построении заново
+	if (only_additions && standby_handler_ != nullptr && standby_released_->load(std::memory_order_acquire)) {
+		json::Array added_requests;
+		for (size_t id = 0; id < base_requests.size(); ++id) {
+			if (id >= standby_request_count_ || base_requests[id].AsDict().at("type"s).AsString() == "Stop"s) {
+				added_requests.push_back(base_requests[id]);
+			}
+		}
+		root.emplace("base_requests"s, std::move(added_requests));
+		const json::Document doc{ json::Node{ std::move(root) } };
+		JsonReader reader(doc);
+		// при ошибке частично дополненная версия удаляется вместе с reader
+		reader.request_handler = std::move(standby_handler_);
+		reader.ProcessAddedInputRequests();
+		handler = reader.request_handler;
+	}
+	else {
+		root.emplace("base_requests"s, base_requests);
+		const json::Document doc{ json::Node{ std::move(root) } };
+		JsonReader reader(doc);
+		reader.ProcessInputRequests();
+		handler = reader.request_handler;
 	}
-	node.EndArray();
-	return json::Document{ node.Build() };
+	standby_handler_ = only_additions ? std::move(request_handler) : nullptr;
+	standby_released_ = only_additions ? std::move(request_handler_released_) : nullptr;
+	standby_request_count_ = previous_request_count;
+	request_handler = handler;
+	request_handler_released_ = std::make_shared<std::atomic<bool>>(false);
+	base_requests_ = std::move(base_requests);
+	return request_handler::VersionedRequestHandler::TrackRelease(handler, request_handler_released_);
 }
 
 json::Document JsonReader::ProcessJsonDoc() {
 	ProcessInputRequests();
+	request_handler_released_ = std::make_shared<std::atomic<bool>>(false);
+	versions_.Publish(request_handler::VersionedRequestHandler::TrackRelease(request_handler, request_handler_released_));
 	auto result = ProcessStatRequests();
 	return result;
 }
@@ -3,6 +3,13 @@
 #include "json.h"
 #include "json_builder.h"
 #include "request_handler.h"
+#include "versioned_request_handler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
 /*
  * Здесь можно разместить код наполнения транспортного справочника данными из JSON,
  * а также код обработки запросов к базе и формирование массива ответов в формате JSON
@@ -16,8 +23,29 @@ private:
 	// json-документ с запросами
 	const json::Document& doc_;
 
-	// обрботчик запросов к транспортному каталогу и генератору карт
-	request_handler::RequestHandler request_handler;
+	// обрботчик запросов к транспортному каталогу и генератору карт, наполняемый из doc_; после публикации -
+	// последняя построенная версия (меняется только при построении версий)
+	std::shared_ptr<request_handler::RequestHandler> request_handler;
+
+	// запросы на наполнение справочника с учётом обновлений (std::nullopt - запросы doc_ без обновлений);
+	// меняется только при построении версий
+	std::optional<json::Array> base_requests_;
+
+	// признак освобождения опубликованной копии request_handler всеми версиями и читателями
+	// (см. VersionedRequestHandler::TrackRelease)
+	std::shared_ptr<std::atomic<bool>> request_handler_released_;
+
+	// предыдущая версия, если последнее обновление только добавляло остановки и маршруты; когда её больше
+	// не держит ни один читатель (standby_released_), следующее такое обновление дополняет её на месте
+	// вместо построения заново
+	std::shared_ptr<request_handler::RequestHandler> standby_handler_;
+	std::shared_ptr<std::atomic<bool>> standby_released_;
+	// число запросов на наполнение, по которым построена standby_handler_
+	size_t standby_request_count_ = 0;
+
+	// опубликованные версии обработчика запросов; объявлены последними: деструктор дожидается построения
+	// версий, которые используют поля выше
+	request_handler::VersionedRequestHandler versions_;
 public:
 	JsonReader(const json::Document& doc);
 
@@ -35,6 +63,12 @@ private:
 	/// @brief Обработка запросов на вывод информации в генератор SVG карт
 	void ProcessMapRendererInputData();
 
+	/// @brief Дополнение ранее построенного обработчика запросов (справочник, генератор путей, карта)
+	/// @details Справочник размораживается, дополняется и замораживается снова, генератор путей дополняется
+	/// без полного построения (TransportRouter::Update), карта формируется заново. doc_ содержит все
+	/// остановки (известные пропускаются, расстояния задаются заново) и только новые маршруты
+	void ProcessAddedInputRequests();
+
 	/// @brief Обработка json-документа с запросами на добавление остановок
 	/// @param номер запроса на ввод маршрута в транспортный справочник
 	/// @param номер запроса на ввод остановки в транспортный справочник
@@ -51,6 +85,10 @@ private:
 	/// @brief Чтение параметров настройки маршрутизатора
 	void ProcessRoutingSettings();
 
+	/// @brief Обработка настроек генератора путей
+	/// @return настройки генератора путей
+	TransportRouter::RoutingSettings ProcessRoutingSettingsData();
+
 	/// @brief Обработка запросов на добавление параметров настройки генератора SVG карт
 	/// @param настройки генератора SVG карт
 	map_renderer::RenderSettings ProcessRenderSettings();
@@ -62,20 +100,71 @@ private:
 	/// @brief Обработка запроса на вывод информации о маршруте
 	/// @param Заполняемая нода (блок) json-докмента
 	/// @param Запрос
-	void ProcessBusStatRequest(json::Builder& node, const json::Dict& request);
+	/// @param handler версия обработчика запросов
+	void ProcessBusStatRequest(json::Builder& node, const json::Dict& request,
+		const request_handler::RequestHandler& handler);
 
 	/// @brief Обработка запроса на вывод информации об остановке
 	/// @param Заполняемая нода (блок) json-докмента
 	/// @param Запрос
-	void ProcessStopStatRequest(json::Builder& node, const json::Dict& request);
+	/// @param handler версия обработчика запросов
+	void ProcessStopStatRequest(json::Builder& node, const json::Dict& request,
+		const request_handler::RequestHandler& handler);
 
 	/// @brief Обработка запроса на вывод карты маршрутов
 	/// @param Заполняемая нода (блок) json-докмента
 	/// @param Запрос
-	void ProcessMapStatRequest(json::Builder& node, const json::Dict& request);
+	/// @param handler версия обработчика запросов
+	void ProcessMapStatRequest(json::Builder& node, const json::Dict& request,
+		const request_handler::RequestHandler& handler);
 
 	/// @brief Обработка запроса на вывод найденного пути между остановками
 	/// @param Заполняемая нода (блок) json-докмента
 	/// @param Запрос
-	void ProcessRouteStatRequest(json::Builder& node, const json::Dict& request);
+	/// @param handler версия обработчика запросов
+	void ProcessRouteStatRequest(json::Builder& node, const json::Dict& request,
+		const request_handler::RequestHandler& handler);
+
+	/// @brief Обработка запроса на вывод только времени в пути между остановками (без списка пересадок)
+	/// @param Заполняемая нода (блок) json-докмента
+	/// @param Запрос
+	/// @param handler версия обработчика запросов
+	void ProcessRouteTimeStatRequest(json::Builder& node, const json::Dict& request,
+		const request_handler::RequestHandler& handler);
+
+	/// @brief Обработка запроса на вывод матрицы времён в пути между наборами остановок
+	/// @param Заполняемая нода (блок) json-докмента
+	/// @param Запрос
+	/// @param handler версия обработчика запросов
+	void ProcessMatrixStatRequest(json::Builder& node, const json::Dict& request,
+		const request_handler::RequestHandler& handler);
+
+	/// @brief Обработка запроса на вывод остановок, достижимых за заданное время (изохроны)
+	/// @param Заполняемая нода (блок) json-докмента
+	/// @param Запрос
+	/// @param handler версия обработчика запросов
+	void ProcessIsochroneStatRequest(json::Builder& node, const json::Dict& request,
+		const request_handler::RequestHandler& handler);
+
+	/// @brief Обработка запроса на вывод статистики генератора путей (поиски, кэши, метки хабов)
+	/// @param Заполняемая нода (блок) json-докмента
+	/// @param Запрос
+	/// @param handler версия обработчика запросов
+	void ProcessRouterStatsRequest(json::Builder& node, const json::Dict& request,
+		const request_handler::RequestHandler& handler);
+
+	/// @brief Обработка запроса на обновление справочника: следующая версия строится в фоне
+	/// @param Заполняемая нода (блок) json-докмента
+	/// @param Запрос
+	/// @return результат построения, если запрос его не ждёт (ответ дополняется ошибкой, если построение
+	/// не удалось); иначе недействительный future
+	std::future<uint64_t> ProcessUpdateRequest(json::Builder& node, const json::Dict& request);
+
+	/// @brief Построение обработчика запросов по запросам на наполнение с учётом обновления
+	/// @details Выполняется в потоке построения версий; base_requests_ меняется только при успехе.
+	/// Если обновление только добавляет остановки и маршруты, дополняется предыдущая версия
+	/// (standby_handler_), иначе обработчик строится заново
+	/// @param update_requests запросы обновления: заменяют запросы того же типа с тем же именем
+	/// или дополняют их
+	std::shared_ptr<const request_handler::RequestHandler> BuildUpdatedRequestHandler(const json::Array& update_requests);
 };
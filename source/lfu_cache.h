@@ -0,0 +1,164 @@
+#pragma once
+
+#include "lru_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace cache {
+	/// @brief Потокобезопасный кэш ограниченного размера с вытеснением редко используемых записей (LFU)
+	/// @details Частота обращений учитывается для всех ключей, в том числе отсутствующих в кэше. Значение
+	/// ключа допускается в кэш, если ключ запрашивался не впервые и (при заполненном кэше) чаще, чем ключ
+	/// самой редкой записи, которая и вытесняется. Частоты периодически уменьшаются вдвое, чтобы кэш
+	/// подстраивался под изменение потока запросов. Значения хранятся в shared_ptr: дорогие в построении
+	/// значения не копируются и остаются действительными после вытеснения
+	template <typename Key, typename Value, typename Hash = std::hash<Key>>
+	class LfuCache {
+	public:
+		/// @param capacity максимальное число записей; 0 - кэш отключён
+		explicit LfuCache(size_t capacity = 0)
+			: capacity_(capacity) {
+		}
+
+		/// @brief Задать максимальное число записей (содержимое кэша и частоты ключей сбрасываются)
+		void SetCapacity(size_t capacity) {
+			std::lock_guard lock(mutex_);
+			capacity_ = capacity;
+			entries_.clear();
+			frequencies_.clear();
+			access_count_ = 0;
+		}
+
+		/// @brief Изменить максимальное число записей, сохранив частоты ключей и статистику
+		/// @details Если записей больше новой ёмкости, вытесняются самые редкие
+		void Resize(size_t capacity) {
+			std::lock_guard lock(mutex_);
+			capacity_ = capacity;
+			while (entries_.size() > capacity_) {
+				entries_.erase(FindVictim());
+				++stats_.evictions;
+			}
+		}
+
+		size_t GetCapacity() const {
+			std::lock_guard lock(mutex_);
+			return capacity_;
+		}
+
+		/// @brief Поиск значения; обращение учитывается в частоте ключа
+		/// @return nullptr, если значения нет в кэше
+		std::shared_ptr<const Value> Get(const Key& key) {
+			std::lock_guard lock(mutex_);
+			if (capacity_ == 0) {
+				return nullptr;
+			}
+			RecordAccess(key);
+			const auto it = entries_.find(key);
+			if (it == entries_.end()) {
+				++stats_.misses;
+				return nullptr;
+			}
+			++stats_.hits;
+			return it->second;
+		}
+
+		/// @brief Будет ли значение ключа принято в кэш (стоит ли его строить)
+		bool ShouldAdmit(const Key& key) const {
+			std::lock_guard lock(mutex_);
+			if (capacity_ == 0 || entries_.count(key) != 0) {
+				return false;
+			}
+			const uint32_t frequency = GetFrequency(key);
+			if (frequency < MIN_ADMISSION_FREQUENCY) {
+				return false;
+			}
+			return entries_.size() < capacity_ || GetFrequency(FindVictim()->first) < frequency;
+		}
+
+		/// @brief Добавление (или замена) значения; при заполненном кэше вытесняется самая редкая запись,
+		/// если ключ запрашивается чаще неё, иначе значение не добавляется
+		void Put(const Key& key, std::shared_ptr<const Value> value) {
+			std::lock_guard lock(mutex_);
+			if (capacity_ == 0) {
+				return;
+			}
+			if (const auto it = entries_.find(key); it != entries_.end()) {
+				it->second = std::move(value);
+				return;
+			}
+			if (entries_.size() == capacity_) {
+				const auto victim = FindVictim();
+				if (!(GetFrequency(victim->first) < GetFrequency(key))) {
+					return;
+				}
+				entries_.erase(victim);
+				++stats_.evictions;
+			}
+			entries_.emplace(key, std::move(value));
+		}
+
+		/// @brief Удаление всех записей; частоты ключей и статистика сохраняются
+		void Clear() {
+			std::lock_guard lock(mutex_);
+			entries_.clear();
+		}
+
+		CacheStats GetStats() const {
+			std::lock_guard lock(mutex_);
+			return stats_;
+		}
+
+	private:
+		// значение принимается в кэш начиная со второго обращения к ключу
+		static constexpr uint32_t MIN_ADMISSION_FREQUENCY = 2;
+		// частоты уменьшаются вдвое каждые AGING_PERIOD * capacity обращений
+		static constexpr size_t AGING_PERIOD = 16;
+
+		using Entries = std::unordered_map<Key, std::shared_ptr<const Value>, Hash>;
+
+		void RecordAccess(const Key& key) {
+			++frequencies_[key];
+			if (++access_count_ < AGING_PERIOD * capacity_) {
+				return;
+			}
+			access_count_ = 0;
+			for (auto it = frequencies_.begin(); it != frequencies_.end();) {
+				it->second /= 2;
+				// ключи с нулевой частотой забываются, поэтому число отслеживаемых ключей ограничено
+				if (it->second == 0 && entries_.count(it->first) == 0) {
+					it = frequencies_.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+		}
+
+		uint32_t GetFrequency(const Key& key) const {
+			const auto it = frequencies_.find(key);
+			return it == frequencies_.end() ? 0 : it->second;
+		}
+
+		/// @brief Запись с наименьшей частотой (линейный просмотр: записей немного, а сами значения дорогие)
+		typename Entries::const_iterator FindVictim() const {
+			auto victim = entries_.begin();
+			for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+				if (GetFrequency(it->first) < GetFrequency(victim->first)) {
+					victim = it;
+				}
+			}
+			return victim;
+		}
+
+		mutable std::mutex mutex_;
+		size_t capacity_;
+		Entries entries_;
+		std::unordered_map<Key, uint32_t, Hash> frequencies_;
+		// число обращений с последнего уменьшения частот
+		size_t access_count_ = 0;
+		CacheStats stats_;
+	};
+}  // namespace cache
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+	/// @brief статистика обращений к кэшу
+	struct CacheStats {
+		size_t hits = 0;
+		size_t misses = 0;
+		// число записей, вытесненных для освобождения места
+		size_t evictions = 0;
+
+		/// @brief Доля попаданий среди всех обращений
+		double GetHitRate() const {
+			const size_t requests = hits + misses;
+			return requests == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(requests);
+		}
+	};
+
+	/// @brief Потокобезопасный кэш ограниченного размера с вытеснением давно не использованных записей (LRU)
+	template <typename Key, typename Value, typename Hash = std::hash<Key>>
+	class LruCache {
+	public:
+		/// @param capacity максимальное число записей; 0 - кэш отключён
+		explicit LruCache(size_t capacity = 0)
+			: capacity_(capacity) {
+		}
+
+		/// @brief Задать максимальное число записей (содержимое кэша сбрасывается)
+		void SetCapacity(size_t capacity) {
+			std::lock_guard lock(mutex_);
+			capacity_ = capacity;
+			items_.clear();
+			index_.clear();
+		}
+
+		size_t GetCapacity() const {
+			std::lock_guard lock(mutex_);
+			return capacity_;
+		}
+
+		/// @brief Поиск значения; найденная запись становится самой свежей
+		std::optional<Value> Get(const Key& key) {
+			std::lock_guard lock(mutex_);
+			const auto it = index_.find(key);
+			if (it == index_.end()) {
+				++stats_.misses;
+				return std::nullopt;
+			}
+			++stats_.hits;
+			items_.splice(items_.begin(), items_, it->second);
+			return it->second->second;
+		}
+
+		/// @brief Добавление (или замена) значения; при переполнении вытесняется самая старая запись
+		void Put(const Key& key, Value value) {
+			std::lock_guard lock(mutex_);
+			if (capacity_ == 0) {
+				return;
+			}
+			if (const auto it = index_.find(key); it != index_.end()) {
+				it->second->second = std::move(value);
+				items_.splice(items_.begin(), items_, it->second);
+				return;
+			}
+			if (items_.size() == capacity_) {
+				index_.erase(items_.back().first);
+				items_.pop_back();
+				++stats_.evictions;
+			}
+			items_.emplace_front(key, std::move(value));
+			index_[key] = items_.begin();
+		}
+
+		/// @brief Удаление записей, для которых predicate(key, value) истинен
+		template <typename Predicate>
+		void EraseIf(Predicate predicate) {
+			std::lock_guard lock(mutex_);
+			for (auto it = items_.begin(); it != items_.end();) {
+				if (predicate(it->first, it->second)) {
+					index_.erase(it->first);
+					it = items_.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+		}
+
+		/// @brief Удаление всех записей (статистика сохраняется)
+		void Clear() {
+			std::lock_guard lock(mutex_);
+			items_.clear();
+			index_.clear();
+		}
+
+		CacheStats GetStats() const {
+			std::lock_guard lock(mutex_);
+			return stats_;
+		}
+
+	private:
+		mutable std::mutex mutex_;
+		size_t capacity_;
+		// записи от самой свежей к самой старой
+		std::list<std::pair<Key, Value>> items_;
+		std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator, Hash> index_;
+		CacheStats stats_;
+	};
+}  // namespace cache
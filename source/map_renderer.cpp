@@ -1,5 +1,7 @@
 #include "map_renderer.h"
 
+#include <algorithm>
+
 /*
  * В этом файле вы можете разместить код, отвечающий за визуализацию карты маршрутов в формате SVG.
  * Визуализация маршрутов вам понадобится во второй части итогового проекта.
@@ -25,7 +27,13 @@ namespace map_renderer {
 	}
 
 	void MapRenderer::AddRoute(const domain::RouteData* route) {
-		routes_.insert(route);
+		routes_.push_back(route);
+	}
+
+	void MapRenderer::Clear() {
+		doc_.Clear();
+		geo_coords_.clear();
+		routes_.clear();
 	}
 
 	void MapRenderer::SetPolylineSettings(svg::Polyline& polyline, size_t color_id) {
@@ -50,7 +58,7 @@ namespace map_renderer {
 			.SetFontSize(render_settings_.route_size)
 			.SetFontFamily("Verdana"s)
 			.SetFontWeight("bold"s)
-			.SetData(route_data->name);
+			.SetData(std::string(route_data->name));
 	}
 
 	void MapRenderer::SetMainRouteTextSettings(svg::Text& text, const domain::RouteData* route_data, const geo::SphereProjector& proj, size_t color_id) {
@@ -63,7 +71,7 @@ namespace map_renderer {
 			.SetFontSize(render_settings_.route_size)
 			.SetFontFamily("Verdana"s)
 			.SetFontWeight("bold")
-			.SetData(route_data->name);
+			.SetData(std::string(route_data->name));
 	}
 
 	void MapRenderer::SetUnderlayerStopTextSettings(svg::Text& text, const domain::StopData* stop_data, const geo::SphereProjector& proj) {
@@ -79,7 +87,7 @@ namespace map_renderer {
 			.SetOffset(render_settings_.stop_offset)
 			.SetFontSize(render_settings_.stop_size)
 			.SetFontFamily("Verdana"s)
-			.SetData(stop_data->name);
+			.SetData(std::string(stop_data->name));
 	}
 
 	void MapRenderer::SetMainStopTextSettings(svg::Text& text, const domain::StopData* stop_data, const geo::SphereProjector& proj) {
@@ -91,7 +99,7 @@ namespace map_renderer {
 			.SetOffset(render_settings_.stop_offset)
 			.SetFontSize(render_settings_.stop_size)
 			.SetFontFamily("Verdana"s)
-			.SetData(stop_data->name);
+			.SetData(std::string(stop_data->name));
 	}
 
 	void MapRenderer::PrepareSvgDoc() {
@@ -106,9 +114,13 @@ namespace map_renderer {
 			geo_coords_.begin(), geo_coords_.end(), render_settings_.width, render_settings_.height, render_settings_.padding
 		};
 
+		// маршруты выводятся в порядке номеров, остановки - в порядке названий
+		std::sort(routes_.begin(), routes_.end(), domain::PointerRouteDataCompareLow{});
 		std::list<svg::Text> texts;
 		size_t color_id = 0;
-		std::set<const domain::StopData*, domain::PointerStopDataCompareLow> stops_for_svg;
+		std::vector<const domain::StopData*> stops_for_svg;
+		// уникальные остановки отмечаются по id
+		std::vector<bool> stop_added;
 		for (const auto& route_data : routes_) {
 			if (route_data->stops_count == 0)
 				continue;
@@ -124,7 +136,13 @@ namespace map_renderer {
 			texts.push_back(main_text); // первая остановка маршута
 			color_id = (++color_id == render_settings_.color_palette.size()) ? 0 : color_id;
 			for (const auto& stop : route_data->stops_) {
-				stops_for_svg.insert(stop); // уникальные остановки для вывода в svg
+				if (stop->id >= stop_added.size()) {
+					stop_added.resize(stop->id + 1, false);
+				}
+				if (!stop_added[stop->id]) { // уникальные остановки для вывода в svg
+					stop_added[stop->id] = true;
+					stops_for_svg.push_back(stop);
+				}
 				const svg::Point screen_coord = proj(stop->coordinates);
 				polyline.AddPoint(screen_coord);
 			}
@@ -135,7 +153,7 @@ namespace map_renderer {
 					polyline.AddPoint(screen_coord);
 				}
 				// Название маршрута на конечной
-				if ((*route_data->stops_.cbegin())->name != (*route_data->stops_.crbegin())->name) { // остановки не должны совпадать
+				if ((*route_data->stops_.cbegin())->id != (*route_data->stops_.crbegin())->id) { // остановки не должны совпадать
 					underlayer_text.SetPosition(proj((*route_data->stops_.rbegin())->coordinates));
 					texts.push_back(underlayer_text);
 					main_text.SetPosition(proj((*route_data->stops_.rbegin())->coordinates));
@@ -144,6 +162,7 @@ namespace map_renderer {
 			}
 			doc_.Add(polyline);
 		}
+		std::sort(stops_for_svg.begin(), stops_for_svg.end(), domain::PointerStopDataCompareLow{});
 		// добавляем к списку на рендер названия маршрутов
 		for (const auto& text : texts) {
 			doc_.Add(text);
@@ -40,7 +40,8 @@ namespace map_renderer {
 		RenderSettings render_settings_{};
 		svg::Document doc_{};
 		std::vector<geo::Coordinates> geo_coords_{};
-		std::set<const domain::RouteData*, domain::PointerRouteDataCompareLow> routes_{};
+		// маршруты в порядке добавления; упорядочиваются по номерам при формировании документа
+		std::vector<const domain::RouteData*> routes_{};
 
 	public:
 		MapRenderer() = default;
@@ -65,6 +66,9 @@ namespace map_renderer {
 		/// @param route маршрут из БД
 		void AddRoute(const domain::RouteData* route);
 
+		/// @brief удалить координаты, маршруты и сформированный документ (настройки сохраняются)
+		void Clear();
+
 		void SetPolylineSettings(svg::Polyline& polyline, size_t color_id);
 		void SetUnderlayerRouteTextSettings(svg::Text& text, const domain::RouteData* route_data, const geo::SphereProjector& proj);
 		void SetMainRouteTextSettings(svg::Text& text, const domain::RouteData* route_data, const geo::SphereProjector& proj, size_t color_id);
@@ -0,0 +1,70 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace storage {
+#ifdef _WIN32
+	MappedFile::MappedFile(const std::string& path) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file) {
+			throw std::runtime_error("Can't open file " + path);
+		}
+		size_ = static_cast<size_t>(file.tellg());
+		buffer_.resize((size_ + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t));
+		file.seekg(0);
+		if (!file.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(size_))) {
+			throw std::runtime_error("Can't read file " + path);
+		}
+		data_ = reinterpret_cast<const char*>(buffer_.data());
+	}
+
+	MappedFile::~MappedFile() = default;
+#else
+	MappedFile::MappedFile(const std::string& path) {
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			throw std::runtime_error("Can't open file " + path);
+		}
+		struct stat file_stat {};
+		if (fstat(fd, &file_stat) != 0) {
+			close(fd);
+			throw std::runtime_error("Can't read file " + path);
+		}
+		size_ = static_cast<size_t>(file_stat.st_size);
+		// пустой файл не отображается: mmap нулевой длины не допускается
+		if (size_ > 0) {
+			void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED) {
+				close(fd);
+				throw std::runtime_error("Can't map file " + path);
+			}
+			data_ = static_cast<const char*>(data);
+		}
+		// отображение остаётся действительным и после закрытия дескриптора
+		close(fd);
+	}
+
+	MappedFile::~MappedFile() {
+		if (data_ != nullptr) {
+			munmap(const_cast<char*>(data_), size_);
+		}
+	}
+#endif
+
+	const char* MappedFile::GetData() const {
+		return data_;
+	}
+
+	size_t MappedFile::GetSize() const {
+		return size_;
+	}
+}  // namespace storage
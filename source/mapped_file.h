@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace storage {
+	/// @brief Файл, отображённый в память только для чтения
+	/// @details В POSIX-системах файл отображается mmap, и его страницы подгружаются по мере обращения;
+	/// в Windows файл целиком читается в память
+	class MappedFile {
+	public:
+		/// @param path путь к файлу
+		/// @throws std::runtime_error, если файл не удалось открыть или отобразить
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/// @brief Начало содержимого файла (выровнено не хуже, чем для любого скалярного типа)
+		const char* GetData() const;
+
+		/// @brief Размер файла, байт
+		size_t GetSize() const;
+
+	private:
+		const char* data_ = nullptr;
+		size_t size_ = 0;
+#ifdef _WIN32
+		std::vector<std::max_align_t> buffer_;
+#endif
+	};
+}  // namespace storage
@@ -0,0 +1,138 @@
+#include "min_plus_kernel.h"
+
+// SIMD-версии собираются только для x86 компиляторами GCC/Clang, поддерживающими target-атрибуты
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MIN_PLUS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace graph {
+	namespace min_plus {
+		namespace {
+			using RelaxRowFunction = void (*)(double*, PrevEdgeId*, const double*, const PrevEdgeId*,
+				double, PrevEdgeId, size_t);
+
+#ifdef MIN_PLUS_X86_SIMD
+			__attribute__((target("avx2")))
+			void RelaxRowAvx2(double* weights_from, PrevEdgeId* prev_edges_from,
+				const double* weights_through, const PrevEdgeId* prev_edges_through,
+				double weight_from, PrevEdgeId prev_edge_from, size_t count) {
+				const __m256d weight_from_vec = _mm256_set1_pd(weight_from);
+				const __m128i prev_edge_from_vec = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+				const __m128i no_edge_vec = _mm_set1_epi32(static_cast<int>(NO_EDGE));
+				size_t j = 0;
+				for (; j + 4 <= count; j += 4) {
+					const __m256d candidate = _mm256_add_pd(weight_from_vec, _mm256_loadu_pd(weights_through + j));
+					const __m256d current = _mm256_loadu_pd(weights_from + j);
+					const __m256d less = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+					if (_mm256_movemask_pd(less) == 0) {
+						continue;
+					}
+					_mm256_storeu_pd(weights_from + j, _mm256_blendv_pd(current, candidate, less));
+					// маска из 64-битных элементов в 32-битные: берём младшие половины
+					const __m128 less_low = _mm_castpd_ps(_mm256_castpd256_pd128(less));
+					const __m128 less_high = _mm_castpd_ps(_mm256_extractf128_pd(less, 1));
+					const __m128i less32 = _mm_castps_si128(_mm_shuffle_ps(less_low, less_high, _MM_SHUFFLE(2, 0, 2, 0)));
+
+					const __m128i prev_through = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + j));
+					const __m128i prev_current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_from + j));
+					const __m128i prev_candidate = _mm_blendv_epi8(prev_through, prev_edge_from_vec,
+						_mm_cmpeq_epi32(prev_through, no_edge_vec));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges_from + j),
+						_mm_blendv_epi8(prev_current, prev_candidate, less32));
+				}
+				RelaxRowScalar(weights_from + j, prev_edges_from + j, weights_through + j, prev_edges_through + j,
+					weight_from, prev_edge_from, count - j);
+			}
+
+			__attribute__((target("avx512f")))
+			void RelaxRowAvx512(double* weights_from, PrevEdgeId* prev_edges_from,
+				const double* weights_through, const PrevEdgeId* prev_edges_through,
+				double weight_from, PrevEdgeId prev_edge_from, size_t count) {
+				const __m512d weight_from_vec = _mm512_set1_pd(weight_from);
+				const __m512i prev_edge_from_vec = _mm512_set1_epi32(static_cast<int>(prev_edge_from));
+				const __m512i no_edge_vec = _mm512_set1_epi32(static_cast<int>(NO_EDGE));
+				size_t j = 0;
+				for (; j + 8 <= count; j += 8) {
+					const __m512d candidate = _mm512_add_pd(weight_from_vec, _mm512_loadu_pd(weights_through + j));
+					const __mmask8 less = _mm512_cmp_pd_mask(candidate, _mm512_loadu_pd(weights_from + j), _CMP_LT_OQ);
+					if (less == 0) {
+						continue;
+					}
+					_mm512_mask_storeu_pd(weights_from + j, less, candidate);
+					// 8 id рёбер занимают младшую половину 512-битного регистра
+					const __m512i prev_through = _mm512_castsi256_si512(
+						_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_through + j)));
+					const __mmask16 no_edge = _mm512_cmpeq_epi32_mask(prev_through, no_edge_vec);
+					const __m512i prev_candidate = _mm512_mask_blend_epi32(no_edge, prev_through, prev_edge_from_vec);
+					_mm512_mask_storeu_epi32(prev_edges_from + j, static_cast<__mmask16>(less), prev_candidate);
+				}
+				RelaxRowScalar(weights_from + j, prev_edges_from + j, weights_through + j, prev_edges_through + j,
+					weight_from, prev_edge_from, count - j);
+			}
+#endif
+
+			InstructionSet DetectInstructionSet() {
+#ifdef MIN_PLUS_X86_SIMD
+				__builtin_cpu_init();
+				if (__builtin_cpu_supports("avx512f")) {
+					return InstructionSet::AVX512;
+				}
+				if (__builtin_cpu_supports("avx2")) {
+					return InstructionSet::AVX2;
+				}
+#endif
+				return InstructionSet::SCALAR;
+			}
+
+			RelaxRowFunction SelectRelaxRow() {
+				switch (GetInstructionSet()) {
+#ifdef MIN_PLUS_X86_SIMD
+				case InstructionSet::AVX512:
+					return RelaxRowAvx512;
+				case InstructionSet::AVX2:
+					return RelaxRowAvx2;
+#endif
+				default:
+					return RelaxRowScalar;
+				}
+			}
+		}  // namespace
+
+		InstructionSet GetInstructionSet() {
+			static const InstructionSet instruction_set = DetectInstructionSet();
+			return instruction_set;
+		}
+
+		std::string_view GetInstructionSetName(InstructionSet instruction_set) {
+			switch (instruction_set) {
+			case InstructionSet::AVX512:
+				return "avx512";
+			case InstructionSet::AVX2:
+				return "avx2";
+			default:
+				return "scalar";
+			}
+		}
+
+		void RelaxRowScalar(double* weights_from, PrevEdgeId* prev_edges_from,
+			const double* weights_through, const PrevEdgeId* prev_edges_through,
+			double weight_from, PrevEdgeId prev_edge_from, size_t count) {
+			for (size_t j = 0; j < count; ++j) {
+				const double candidate = weight_from + weights_through[j];
+				if (candidate < weights_from[j]) {
+					weights_from[j] = candidate;
+					prev_edges_from[j] = prev_edges_through[j] != NO_EDGE ? prev_edges_through[j] : prev_edge_from;
+				}
+			}
+		}
+
+		void RelaxRow(double* weights_from, PrevEdgeId* prev_edges_from,
+			const double* weights_through, const PrevEdgeId* prev_edges_through,
+			double weight_from, PrevEdgeId prev_edge_from, size_t count) {
+			static const RelaxRowFunction relax_row = SelectRelaxRow();
+			relax_row(weights_from, prev_edges_from, weights_through, prev_edges_through,
+				weight_from, prev_edge_from, count);
+		}
+	}  // namespace min_plus
+}  // namespace graph
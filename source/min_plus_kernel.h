@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+namespace graph {
+	/// @brief Векторизованное ядро релаксации строки таблицы путей (min-plus)
+	namespace min_plus {
+		// id последнего ребра пути в таблице путей
+		using PrevEdgeId = uint32_t;
+		// пути нет
+		inline constexpr PrevEdgeId NO_ROUTE = std::numeric_limits<PrevEdgeId>::max();
+		// путь есть, но не содержит рёбер (из вершины в саму себя)
+		inline constexpr PrevEdgeId NO_EDGE = NO_ROUTE - 1;
+
+		/// @brief набор инструкций, используемый ядром
+		enum class InstructionSet {
+			SCALAR,
+			AVX2,
+			AVX512
+		};
+
+		/// @brief Набор инструкций, выбранный по возможностям процессора при первом вызове
+		InstructionSet GetInstructionSet();
+
+		std::string_view GetInstructionSetName(InstructionSet instruction_set);
+
+		/// @brief Релаксация отрезка строки таблицы путей через промежуточную вершину
+		/// @details Для каждого j: если weight_from + weights_through[j] < weights_from[j], то вес заменяется,
+		/// а последним ребром пути становится prev_edges_through[j] (или prev_edge_from, если путь
+		/// через промежуточную вершину до j пуст). Отсутствие пути обозначается бесконечным весом
+		/// @param weights_from веса путей из начальной вершины (обновляются)
+		/// @param prev_edges_from последние рёбра путей из начальной вершины (обновляются)
+		/// @param weights_through веса путей из промежуточной вершины
+		/// @param prev_edges_through последние рёбра путей из промежуточной вершины
+		/// @param weight_from вес пути из начальной вершины в промежуточную
+		/// @param prev_edge_from последнее ребро пути из начальной вершины в промежуточную
+		/// @param count длина отрезка
+		void RelaxRow(double* weights_from, PrevEdgeId* prev_edges_from,
+			const double* weights_through, const PrevEdgeId* prev_edges_through,
+			double weight_from, PrevEdgeId prev_edge_from, size_t count);
+
+		/// @brief Скалярная реализация RelaxRow (для проверки и процессоров без SIMD)
+		void RelaxRowScalar(double* weights_from, PrevEdgeId* prev_edges_from,
+			const double* weights_through, const PrevEdgeId* prev_edges_through,
+			double weight_from, PrevEdgeId prev_edge_from, size_t count);
+	}  // namespace min_plus
+}  // namespace graph
@@ -0,0 +1,97 @@
+#include "perfect_hash_index.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+namespace domain {
+	void PerfectHashIndex::Build(std::vector<std::string_view> keys) {
+		keys_ = std::move(keys);
+		seeds_.clear();
+		slots_.clear();
+		if (keys_.empty()) {
+			return;
+		}
+		std::vector<uint64_t> hashes;
+		hashes.reserve(keys_.size());
+		for (const std::string_view key : keys_) {
+			hashes.push_back(static_cast<uint64_t>(std::hash<std::string_view>{}(key)));
+		}
+		// заполнение слотов не больше 80%: смещения корзин находятся за несколько попыток
+		size_t slot_count = 1;
+		while (slot_count < keys_.size() + keys_.size() / 4) {
+			slot_count *= 2;
+		}
+		while (!TryBuild(hashes, slot_count)) {
+			// смещение не находится только при совпадении полных хэшей разных имён
+			if (slot_count > 64 * keys_.size()) {
+				throw std::logic_error("Can't build a perfect hash index");
+			}
+			slot_count *= 2;
+		}
+	}
+
+	std::optional<uint32_t> PerfectHashIndex::Find(std::string_view key) const {
+		if (slots_.empty()) {
+			return std::nullopt;
+		}
+		const auto hash = static_cast<uint64_t>(std::hash<std::string_view>{}(key));
+		const uint32_t index = slots_[GetSlot(hash, seeds_[GetBucket(hash)])];
+		if (index == EMPTY_SLOT || keys_[index] != key) {
+			return std::nullopt;
+		}
+		return index;
+	}
+
+	size_t PerfectHashIndex::GetSize() const {
+		return keys_.size();
+	}
+
+	bool PerfectHashIndex::TryBuild(const std::vector<uint64_t>& hashes, size_t slot_count) {
+		slots_.assign(slot_count, EMPTY_SLOT);
+		seeds_.assign((hashes.size() + BUCKET_SIZE - 1) / BUCKET_SIZE, 0);
+		std::vector<std::vector<uint32_t>> buckets(seeds_.size());
+		for (size_t index = 0; index < hashes.size(); ++index) {
+			buckets[GetBucket(hashes[index])].push_back(static_cast<uint32_t>(index));
+		}
+		// крупные корзины размещаются первыми, пока свободных слотов больше
+		std::vector<size_t> order(buckets.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&buckets](size_t lhs, size_t rhs) {
+			return buckets[lhs].size() > buckets[rhs].size();
+		});
+		std::vector<size_t> positions;
+		for (const size_t bucket : order) {
+			const auto& indexes = buckets[bucket];
+			if (indexes.empty()) {
+				break;
+			}
+			bool placed = false;
+			for (uint32_t seed = 0; seed < MAX_SEED && !placed; ++seed) {
+				positions.clear();
+				placed = true;
+				for (const uint32_t index : indexes) {
+					const size_t position = GetSlot(hashes[index], seed);
+					// слот занят другой корзиной или другим ключом этой же корзины
+					if (slots_[position] != EMPTY_SLOT
+						|| std::find(positions.begin(), positions.end(), position) != positions.end()) {
+						placed = false;
+						break;
+					}
+					positions.push_back(position);
+				}
+				if (placed) {
+					seeds_[bucket] = seed;
+					for (size_t i = 0; i < indexes.size(); ++i) {
+						slots_[positions[i]] = indexes[i];
+					}
+				}
+			}
+			if (!placed) {
+				return false;
+			}
+		}
+		return true;
+	}
+}  // namespace domain
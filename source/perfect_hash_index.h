@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace domain {
+	/// @brief Неизменяемый индекс имён на идеальном хэшировании: имя -> его номер в наборе
+	/// @details Метод «хэш и смещение»: ключи распределяются по корзинам, для каждой
+	/// корзины подбирается смещение, при котором её ключи попадают в свободные слоты без коллизий. Поиск -
+	/// одно вычисление хэша, два обращения к массивам и одно сравнение строк (для отсеивания чужих имён).
+	/// Индекс хранит string_view: имена должны жить дольше индекса
+	class PerfectHashIndex {
+	public:
+		/// @brief Построение индекса; номер имени - его позиция в keys
+		/// @param keys попарно различные имена
+		void Build(std::vector<std::string_view> keys);
+
+		/// @brief Номер имени в наборе, по которому построен индекс
+		/// @return std::nullopt, если имени нет в наборе
+		std::optional<uint32_t> Find(std::string_view key) const;
+
+		/// @brief Число имён в индексе
+		size_t GetSize() const;
+
+	private:
+		/// @brief Слот ключа с заданным хэшем при смещении seed
+		size_t GetSlot(uint64_t hash, uint32_t seed) const {
+			uint64_t key = hash + static_cast<uint64_t>(seed) * 0x9e3779b97f4a7c15ull;
+			key ^= key >> 33;
+			key *= 0xff51afd7ed558ccdull;
+			key ^= key >> 33;
+			key *= 0xc4ceb9fe1a85ec53ull;
+			key ^= key >> 33;
+			return static_cast<size_t>(key) & (slots_.size() - 1);
+		}
+
+		/// @brief Корзина ключа: старшие биты хэша, отображённые на число корзин умножением (без деления)
+		size_t GetBucket(uint64_t hash) const {
+			return static_cast<size_t>(((hash >> 32) * seeds_.size()) >> 32);
+		}
+
+		/// @brief Подбор смещений корзин при заданном числе слотов
+		/// @return false, если для какой-либо корзины смещение не найдено
+		bool TryBuild(const std::vector<uint64_t>& hashes, size_t slot_count);
+
+		// номер пустого слота
+		static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+		// среднее число ключей в корзине
+		static constexpr size_t BUCKET_SIZE = 4;
+		// число перебираемых смещений корзины до увеличения числа слотов
+		static constexpr uint32_t MAX_SEED = 1 << 16;
+		std::vector<std::string_view> keys_;
+		// смещения корзин
+		std::vector<uint32_t> seeds_;
+		// номера имён по слотам (число слотов - степень двойки)
+		std::vector<uint32_t> slots_;
+	};
+}  // namespace domain
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <iterator>
 #include <string_view> // зачем?
 #include <unordered_map> // зачем?
@@ -33,4 +34,46 @@ namespace ranges {
 		return Range{ container.begin(), container.end() };
 	}
 
+	/// @brief итератор по последовательным целым числам (индексам)
+	template <typename Index>
+	class IndexIterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Index;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Index*;
+		using reference = Index;
+
+		explicit IndexIterator(Index index)
+			: index_(index) {
+		}
+		Index operator*() const {
+			return index_;
+		}
+		IndexIterator& operator++() {
+			++index_;
+			return *this;
+		}
+		IndexIterator operator++(int) {
+			IndexIterator result = *this;
+			++index_;
+			return result;
+		}
+		bool operator==(const IndexIterator& other) const {
+			return index_ == other.index_;
+		}
+		bool operator!=(const IndexIterator& other) const {
+			return index_ != other.index_;
+		}
+
+	private:
+		Index index_;
+	};
+
+	/// @brief интервал индексов [begin, end)
+	template <typename Index>
+	auto AsIndexRange(Index begin, Index end) {
+		return Range{ IndexIterator<Index>{ begin }, IndexIterator<Index>{ end } };
+	}
+
 }  // namespace ranges
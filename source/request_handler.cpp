@@ -36,10 +36,10 @@ namespace request_handler {
 		return strm_svg.str();
 	}
 
-	std::optional<const std::set<const domain::RouteData*, domain::PointerRouteDataCompareLow>*> RequestHandler::GetBusesByStop(std::string_view stop_name) const {
+	std::optional<TransportCatalogue::StopRoutesRange> RequestHandler::GetBusesByStop(std::string_view stop_name) const {
 		const auto stop_data = transport_catalogue_.GetStop(stop_name);
 		if (stop_data != nullptr) {
-			return &(stop_data->routes_);
+			return transport_catalogue_.GetBusesByStop(stop_data->id);
 		}
 		return std::nullopt;
 	}
@@ -56,14 +56,60 @@ namespace request_handler {
 		transport_catalogue_.AddLengthBetweenStops(stop_a, stop_b, distance);
 	}
 
-	void RequestHandler::InitTransportRouter(double bus_wait_time, double bus_velocity) {
-		transport_router_.Init(bus_wait_time, bus_velocity);
+	std::vector<int> RequestHandler::GetLengthsBetweenStops(const std::vector<domain::StopId>& stops) const {
+		return transport_catalogue_.GetLengthsBetweenStops({ stops.data(), stops.data() + stops.size() });
+	}
+
+	void RequestHandler::FreezeTransportCatalogue() {
+		transport_catalogue_.Freeze();
+	}
+
+	void RequestHandler::UnfreezeTransportCatalogue() {
+		transport_catalogue_.Unfreeze();
+	}
+
+	void RequestHandler::InitTransportRouter(const TransportRouter::RoutingSettings& routing_settings) {
+		transport_router_.Init(routing_settings);
+	}
+
+	void RequestHandler::UpdateTransportRouter() {
+		transport_router_.Update();
 	}
 
 	std::optional<TransportRouter::Path> RequestHandler::FindPath(const std::string& from, const std::string& to) const {
 		return transport_router_.FindPath(from, to);
 	}
 
+	std::optional<double> RequestHandler::FindTime(const std::string& from, const std::string& to) const {
+		return transport_router_.FindTime(from, to);
+	}
+
+	std::optional<TransportRouter::TimeMatrix> RequestHandler::FindTimeMatrix(const std::vector<std::string>& from,
+		const std::vector<std::string>& to) const {
+		return transport_router_.FindTimeMatrix(from, to);
+	}
+
+	std::optional<std::vector<TransportRouter::ReachableStop>> RequestHandler::FindReachableStops(const std::string& from,
+		double max_time) const {
+		return transport_router_.FindReachableStops(from, max_time);
+	}
+
+	cache::CacheStats RequestHandler::GetPathCacheStats() const {
+		return transport_router_.GetPathCacheStats();
+	}
+
+	cache::CacheStats RequestHandler::GetPathTreeCacheStats() const {
+		return transport_router_.GetPathTreeCacheStats();
+	}
+
+	graph::SearchStats RequestHandler::GetSearchStats() const {
+		return transport_router_.GetSearchStats();
+	}
+
+	std::optional<graph::HubLabelStats> RequestHandler::GetHubLabelStats() const {
+		return transport_router_.GetHubLabelStats();
+	}
+
 
 	void RequestHandler::SetRenderSettings(map_renderer::RenderSettings&& render_settings) {
 		map_renderer_.SetRenderSettings(std::move(render_settings));
@@ -71,18 +117,20 @@ namespace request_handler {
 
 
 	void RequestHandler::PrepareSvgDoc() {
+		// документ формируется заново, в том числе после дополнения справочника
+		map_renderer_.Clear();
 		map_renderer_.SetCoordinatesContainerSize(transport_catalogue_.GetStopsCount());
 
-		auto all_stops = transport_catalogue_.GetAllStops();
-		for (const auto& [stop_name, stop_data] : all_stops) {
+		const auto& all_stops = transport_catalogue_.GetAllStops();
+		for (const auto& stop_data : all_stops) {
 			// нам нужны только координаты остановок входящих в какой-либо из маршрутов
 			if (!stop_data.routes_.empty()) {
 				map_renderer_.AddGeoCoords(stop_data.coordinates);
 			}
 		}
 
-		auto all_routes = transport_catalogue_.GetAllRoutes();
-		for (const auto& [route_name, route_data] : all_routes) {
+		const auto& all_routes = transport_catalogue_.GetAllRoutes();
+		for (const auto& route_data : all_routes) {
 			map_renderer_.AddRoute(&route_data);
 		}
 
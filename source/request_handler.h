@@ -39,10 +39,10 @@ namespace request_handler {
 		/// @return информация об остановке
 		std::optional<const domain::StopDataRoutes*> GetStopStat(std::string_view stop_name) const;
 
-		/// @brief Возвращает маршруты, проходящие через остановку
+		/// @brief Возвращает маршруты, проходящие через остановку (справочник должен быть заморожен)
 		/// @param имя остановки
-		/// @return set маршрутов
-		std::optional<const std::set<const domain::RouteData*, domain::PointerRouteDataCompareLow>*> GetBusesByStop(std::string_view stop_name) const;
+		/// @return маршруты в порядке номеров; std::nullopt, если остановки нет в справочнике
+		std::optional<TransportCatalogue::StopRoutesRange> GetBusesByStop(std::string_view stop_name) const;
 
 		/// @brief Добавить остановку в трансопртный справочник
 		/// @param информация об остановке
@@ -54,26 +54,75 @@ namespace request_handler {
 		/// @return distance расстояние
 		void AddLengthBetweenStops(std::string_view stop_a, std::string_view stop_b, int distance);
 
+		/// @brief Расстояния по дорогам между соседними остановками последовательности
+		/// @param stops id остановок в порядке проезда
+		/// @return расстояния между stops[i] и stops[i + 1]
+		std::vector<int> GetLengthsBetweenStops(const std::vector<domain::StopId>& stops) const;
+
 		/// @brief Добавить маршрут в трансопртный справочник
 		/// @param инфомрация о маршруте
 		void AddRouteInTransportCatalogue(domain::RouteData&& route_data);
 
+		/// @brief Завершить наполнение трансопртного справочника: построить снимок для запросов
+		void FreezeTransportCatalogue();
+
+		/// @brief Разрешить дополнение трансопртного справочника (снимок удаляется до следующей заморозки)
+		void UnfreezeTransportCatalogue();
+
 		/// @brief Инициализация генератора путей
-		/// @param bus_wait_time время ожидания автобуса
-		/// @param bus_velocity скорость автобуса
-		void InitTransportRouter(double bus_wait_time, double bus_velocity);
+		/// @param routing_settings настройки генератора путей
+		void InitTransportRouter(const TransportRouter::RoutingSettings& routing_settings);
+
+		/// @brief дополнить генератор путей остановками и маршрутами, добавленными в справочник после инициализации
+		/// @details справочник должен быть снова заморожен
+		void UpdateTransportRouter();
 
 		/// @brief Поиск пути в графе
 		/// @param from название остановки отправления
 		/// @param to название остановки прибытия
-		/// @return найденный пути
+		/// @return найденный путь; std::nullopt, если пути нет или какой-либо остановки нет в справочнике
 		std::optional<TransportRouter::Path> FindPath(const std::string& from, const std::string& to) const;
 
+		/// @brief Время в пути между остановками без восстановления пути
+		/// @param from название остановки отправления
+		/// @param to название остановки прибытия
+		/// @return время в пути; std::nullopt, если пути нет или какой-либо остановки нет в справочнике
+		std::optional<double> FindTime(const std::string& from, const std::string& to) const;
+
+		/// @brief Расчёт времён в пути между всеми парами остановок из двух наборов
+		/// @param from названия остановок отправления
+		/// @param to названия остановок прибытия
+		/// @return матрица времён; std::nullopt, если какой-либо остановки нет в справочнике
+		std::optional<TransportRouter::TimeMatrix> FindTimeMatrix(const std::vector<std::string>& from,
+			const std::vector<std::string>& to) const;
+
+		/// @brief Остановки, до которых можно доехать не дольше чем за заданное время
+		/// @param from название остановки отправления
+		/// @param max_time наибольшее время в пути, мин
+		/// @return остановки в порядке возрастания времени; std::nullopt, если остановки нет в справочнике
+		std::optional<std::vector<TransportRouter::ReachableStop>> FindReachableStops(const std::string& from,
+			double max_time) const;
+
+		/// @brief Статистика кэша найденных путей
+		/// @return число попаданий и промахов
+		cache::CacheStats GetPathCacheStats() const;
+
+		/// @brief Статистика кэша деревьев кратчайших путей
+		cache::CacheStats GetPathTreeCacheStats() const;
+
+		/// @brief Статистика поисков пути по запросу
+		/// @return число поисков и просмотренных вершин
+		graph::SearchStats GetSearchStats() const;
+
+		/// @brief Статистика размеров меток хабов
+		/// @return std::nullopt, если используется другой алгоритм поиска пути
+		std::optional<graph::HubLabelStats> GetHubLabelStats() const;
+
 		/// @brief установить настройки визуализатора
 		/// @param render_settings настройки
 		void SetRenderSettings(map_renderer::RenderSettings&& render_settings);
 
-		/// @brief сформировать SVG документ с маршрутами (визуализация)
+		/// @brief сформировать SVG документ с маршрутами (визуализация); прежний документ заменяется
 		void PrepareSvgDoc();
 
 		/// @brief рендер SVG с картой маршрутов
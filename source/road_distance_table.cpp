@@ -0,0 +1,121 @@
+#include "road_distance_table.h"
+
+#include <stdexcept>
+
+namespace domain {
+	namespace {
+		/// @brief Предварительная загрузка строки кэша (подсказка процессору, без влияния на результат)
+		inline void Prefetch([[maybe_unused]] const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+			__builtin_prefetch(address);
+#endif
+		}
+	}  // namespace
+
+	void RoadDistanceTable::Set(StopId from, StopId to, int distance) {
+		// заполнение не превышает половины слотов: цепочки пробирования остаются короткими
+		if (2 * (size_ + 1) > slots_.size()) {
+			Grow();
+		}
+		const uint64_t key = PackKey(from, to);
+		const size_t mask = slots_.size() - 1;
+		for (size_t position = HashKey(key) & mask;; position = (position + 1) & mask) {
+			Slot& slot = slots_[position];
+			if (slot.key == key) {
+				slot.distance = distance;
+				return;
+			}
+			if (slot.key == EMPTY_KEY) {
+				slot = { key, distance };
+				++size_;
+				return;
+			}
+		}
+	}
+
+	std::optional<int> RoadDistanceTable::Find(StopId from, StopId to) const {
+		if (slots_.empty()) {
+			return std::nullopt;
+		}
+		const size_t mask = slots_.size() - 1;
+		const uint64_t key = PackKey(from, to);
+		if (const Slot* slot = FindSlot(key, HashKey(key) & mask)) {
+			return slot->distance;
+		}
+		const uint64_t reverse_key = PackKey(to, from);
+		if (const Slot* slot = FindSlot(reverse_key, HashKey(reverse_key) & mask)) {
+			return slot->distance;
+		}
+		return std::nullopt;
+	}
+
+	int RoadDistanceTable::Get(StopId from, StopId to) const {
+		if (const auto distance = Find(from, to)) {
+			return *distance;
+		}
+		throw std::out_of_range("Road distance between stops is not set");
+	}
+
+	std::vector<int> RoadDistanceTable::GetConsecutive(ranges::Range<const StopId*> stops_range) const {
+		const StopId* stops = stops_range.begin();
+		const auto stop_count = static_cast<size_t>(stops_range.end() - stops_range.begin());
+		if (stop_count < 2) {
+			return {};
+		}
+		if (slots_.empty()) {
+			throw std::out_of_range("Road distance between stops is not set");
+		}
+		const size_t pair_count = stop_count - 1;
+		std::vector<int> distances(pair_count);
+		// сначала вычисляются и загружаются слоты всех пар, затем выполняется поиск
+		const size_t mask = slots_.size() - 1;
+		std::vector<size_t> positions(pair_count);
+		for (size_t i = 0; i < pair_count; ++i) {
+			positions[i] = HashKey(PackKey(stops[i], stops[i + 1])) & mask;
+			Prefetch(&slots_[positions[i]]);
+		}
+		for (size_t i = 0; i < pair_count; ++i) {
+			if (const Slot* slot = FindSlot(PackKey(stops[i], stops[i + 1]), positions[i])) {
+				distances[i] = slot->distance;
+			}
+			// обратное расстояние нужно редко: ищется отдельно
+			else {
+				distances[i] = Get(stops[i], stops[i + 1]);
+			}
+		}
+		return distances;
+	}
+
+	size_t RoadDistanceTable::GetSize() const {
+		return size_;
+	}
+
+	const RoadDistanceTable::Slot* RoadDistanceTable::FindSlot(uint64_t key, size_t position) const {
+		const size_t mask = slots_.size() - 1;
+		for (;; position = (position + 1) & mask) {
+			const Slot& slot = slots_[position];
+			if (slot.key == key) {
+				return &slot;
+			}
+			if (slot.key == EMPTY_KEY) {
+				return nullptr;
+			}
+		}
+	}
+
+	void RoadDistanceTable::Grow() {
+		std::vector<Slot> old_slots(slots_.empty() ? MIN_CAPACITY : 2 * slots_.size(), Slot{ EMPTY_KEY, 0 });
+		old_slots.swap(slots_);
+		const size_t mask = slots_.size() - 1;
+		for (const Slot& old_slot : old_slots) {
+			if (old_slot.key == EMPTY_KEY) {
+				continue;
+			}
+			size_t position = HashKey(old_slot.key) & mask;
+			while (slots_[position].key != EMPTY_KEY) {
+				position = (position + 1) & mask;
+			}
+			slots_[position] = old_slot;
+		}
+	}
+}  // namespace domain
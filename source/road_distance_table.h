@@ -0,0 +1,72 @@
+#pragma once
+
+#include "domain.h"
+#include "ranges.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace domain {
+	/// @brief Таблица расстояний по дорогам между парами остановок
+	/// @details Плоская хэш-таблица с открытой адресацией (линейное пробирование): ключ - пара id остановок,
+	/// упакованная в 64-битное число (from << 32 | to), ключ и расстояние лежат в одном слоте. Расстояние
+	/// несимметрично: если расстояние от A до B не задано, используется расстояние от B до A
+	class RoadDistanceTable {
+	public:
+		/// @brief Задание расстояния от остановки from до остановки to (заменяет заданное ранее)
+		void Set(StopId from, StopId to, int distance);
+
+		/// @brief Расстояние от from до to, а если оно не задано - от to до from
+		/// @return std::nullopt, если не задано ни одно из них
+		std::optional<int> Find(StopId from, StopId to) const;
+
+		/// @brief Расстояние от from до to с тем же правилом, что у Find
+		/// @throws std::out_of_range, если расстояние не задано
+		int Get(StopId from, StopId to) const;
+
+		/// @brief Расстояния между соседними остановками последовательности (например, маршрута)
+		/// @details Пакетный поиск: слоты всех пар вычисляются и запрашиваются в кэш заранее, поэтому
+		/// промахи кэша при обращении к таблице перекрываются
+		/// @return distances[i] - расстояние от stops[i] до stops[i + 1] (по правилу Get)
+		/// @throws std::out_of_range, если расстояние для какой-либо пары не задано
+		std::vector<int> GetConsecutive(ranges::Range<const StopId*> stops) const;
+
+		/// @brief Число заданных расстояний
+		size_t GetSize() const;
+
+	private:
+		struct Slot {
+			uint64_t key;
+			int distance;
+		};
+
+		static uint64_t PackKey(StopId from, StopId to) {
+			return (static_cast<uint64_t>(from) << 32) | static_cast<uint64_t>(to);
+		}
+
+		/// @brief Перемешивание битов ключа (финализатор MurmurHash3): соседние id дают далёкие слоты
+		static uint64_t HashKey(uint64_t key) {
+			key ^= key >> 33;
+			key *= 0xff51afd7ed558ccdull;
+			key ^= key >> 33;
+			key *= 0xc4ceb9fe1a85ec53ull;
+			key ^= key >> 33;
+			return key;
+		}
+
+		/// @brief Слот с ключом, начиная поиск с заданного; nullptr, если ключа нет
+		const Slot* FindSlot(uint64_t key, size_t position) const;
+
+		/// @brief Увеличение числа слотов вдвое с перераспределением ключей
+		void Grow();
+
+		// ключ пустого слота: пара из двух наибольших id остановок не используется
+		static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+		// начальное число слотов (степень двойки)
+		static constexpr size_t MIN_CAPACITY = 16;
+		std::vector<Slot> slots_;
+		size_t size_ = 0;
+	};
+}  // namespace domain
@@ -1,118 +1,413 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus_kernel.h"
+#include "router_base.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <iostream>
 namespace graph {
-	/// @brief Маршрутизатор
+	/// @brief Маршрутизатор, заранее рассчитывающий пути между всеми парами вершин (Флойд-Уоршелл)
+	/// @details Таблица путей хранится двумя непрерывными массивами по строкам: веса путей и 32-битные id
+	/// последних рёбер путей; отсутствие пути обозначается специальным значением id. Алгоритм выполняется
+	/// блоками (tiled Floyd-Warshall): на каждом шаге сначала обновляется диагональный блок,
+	/// затем независимые блоки его строки и столбца, затем все остальные блоки; блоки одной фазы
+	/// обрабатываются параллельно в пуле потоков. Внутренний цикл по строке (min-plus) для весов
+	/// типа double выполняется SIMD-ядром с выбором набора инструкций во время работы
 	template <typename Weight>
-	class Router {
+	class Router : public RouterBase<Weight> {
 	private:
 		using Graph = DirectedWeightedGraph<Weight>;
 
 	public:
-		explicit Router(const Graph& graph);
+		using typename RouterBase<Weight>::RouteInfo;
+		// id последнего ребра пути хранится 32-битным числом; два старших значения зарезервированы
+		using PrevEdgeId = min_plus::PrevEdgeId;
 
-		struct RouteInfo {
-			Weight weight;
-			std::vector<EdgeId> edges;
+		/// @brief таблица путей: V*V весов и V*V id последних рёбер путей по строкам
+		struct RoutesTable {
+			size_t vertex_count = 0;
+			// число рёбер графа, по которому рассчитана таблица
+			size_t edge_count = 0;
+			const Weight* weights = nullptr;
+			const PrevEdgeId* prev_edges = nullptr;
 		};
 
-		std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+		/// @param graph граф
+		/// @param thread_count число потоков для расчёта; 0 - по числу ядер
+		explicit Router(const Graph& graph, size_t thread_count = 1);
+
+		/// @brief Маршрутизатор по рассчитанной ранее таблице путей (например, отображённой в память из файла)
+		/// @details Таблица не копируется; копия делается только при обновлении (см. Update)
+		/// @param graph граф, по которому рассчитана таблица
+		/// @param table таблица путей
+		/// @param storage владелец памяти таблицы, хранится, пока таблица используется
+		/// @param thread_count число потоков для обновления таблицы; 0 - по числу ядер
+		Router(const Graph& graph, RoutesTable table, std::shared_ptr<const void> storage, size_t thread_count = 1);
+
+		/// @brief Текущая таблица путей, например для сохранения в файл
+		/// @details Действительна до обновления или разрушения маршрутизатора
+		RoutesTable GetRoutesTable() const;
+
+		std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+		/// @brief Вес пути берётся из таблицы, O(1)
+		std::optional<Weight> BuildRouteWeight(VertexId from, VertexId to) const override;
+
+		/// @brief Веса путей берутся из таблицы, O(1) на пару
+		std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+			const std::vector<VertexId>& targets) const override;
+
+		/// @brief Дополнение таблицы путей новыми вершинами и рёбрами без полного пересчёта
+		/// @details Таблица расширяется на новые вершины, id рёбер в ней переводятся в новую нумерацию, затем
+		/// каждое новое ребро u->v вставляется за O(V^2): пути i->j улучшаются путями i->u->v->j, причём
+		/// просматриваются только строки, из которых достижима вершина u
+		bool Update(const std::vector<EdgeId>& new_edge_ids) override;
 
 	private:
-		struct RouteInternalData {
-			Weight weight;
-			std::optional<EdgeId> prev_edge;
-		};
-		using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+		// размер стороны блока таблицы путей
+		static constexpr size_t BLOCK_SIZE = 64;
+		// обновление выполняется вставкой рёбер, пока новых рёбер не больше 1/INCREMENTAL_UPDATE_RATIO от числа вершин
+		static constexpr size_t INCREMENTAL_UPDATE_RATIO = 8;
+		static constexpr PrevEdgeId NO_ROUTE = min_plus::NO_ROUTE;
+		static constexpr PrevEdgeId NO_EDGE = min_plus::NO_EDGE;
+		// для double релаксация строк выполняется векторизованным ядром min_plus::RelaxRow
+		static constexpr bool USE_MIN_PLUS_KERNEL = std::is_same_v<Weight, double>;
+		// вес отсутствующего пути: для ядра это бесконечность, иначе значение не используется
+		static constexpr Weight UNREACHABLE_WEIGHT = USE_MIN_PLUS_KERNEL
+			? std::numeric_limits<Weight>::infinity() : Weight{};
+
+		size_t GetIndex(VertexId from, VertexId to) const {
+			return from * vertex_count_ + to;
+		}
+
+		static void CheckEdgeCount(const Graph& graph) {
+			if (graph.GetEdgeCount() >= NO_EDGE) {
+				throw std::length_error("Too many edges for 32-bit route table");
+			}
+		}
 
 		void InitializeRoutesInternalData(const Graph& graph) {
-			const size_t vertex_count = graph.GetVertexCount();
-			for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-				routes_internal_data_[vertex][vertex] = RouteInternalData{ ZERO_WEIGHT, std::nullopt };
+			CheckEdgeCount(graph);
+			for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+				weights_[GetIndex(vertex, vertex)] = ZERO_WEIGHT;
+				prev_edges_[GetIndex(vertex, vertex)] = NO_EDGE;
 				for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-					const auto& edge = graph.GetEdge(edge_id);
+					const auto& edge = graph.GetArc(edge_id);
 					if (edge.weight < ZERO_WEIGHT) {
 						throw std::domain_error("Edges' weights should be non-negative");
 					}
-					auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-					if (!route_internal_data || route_internal_data->weight > edge.weight) {
-						route_internal_data = RouteInternalData{ edge.weight, edge_id };
+					const size_t index = GetIndex(vertex, edge.to);
+					if (prev_edges_[index] == NO_ROUTE || weights_[index] > edge.weight) {
+						weights_[index] = edge.weight;
+						prev_edges_[index] = static_cast<PrevEdgeId>(edge_id);
 					}
 				}
 			}
 		}
 
-		void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-			const RouteInternalData& route_to) {
-			auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-			const Weight candidate_weight = route_from.weight + route_to.weight;
-			if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-				route_relaxing = { candidate_weight,
-								  route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge };
+		/// @brief Релаксация путей блока (block_from, block_to) через вершины блока block_through
+		void RelaxBlock(size_t block_through, size_t block_from, size_t block_to) {
+			const VertexId through_end = std::min(vertex_count_, (block_through + 1) * BLOCK_SIZE);
+			const VertexId from_end = std::min(vertex_count_, (block_from + 1) * BLOCK_SIZE);
+			const VertexId to_begin = block_to * BLOCK_SIZE;
+			const VertexId to_end = std::min(vertex_count_, (block_to + 1) * BLOCK_SIZE);
+			for (VertexId vertex_through = block_through * BLOCK_SIZE; vertex_through < through_end; ++vertex_through) {
+				const Weight* weights_through = &weights_[GetIndex(vertex_through, 0)];
+				const PrevEdgeId* prev_edges_through = &prev_edges_[GetIndex(vertex_through, 0)];
+				for (VertexId vertex_from = block_from * BLOCK_SIZE; vertex_from < from_end; ++vertex_from) {
+					Weight* weights_from = &weights_[GetIndex(vertex_from, 0)];
+					PrevEdgeId* prev_edges_from = &prev_edges_[GetIndex(vertex_from, 0)];
+					if (prev_edges_from[vertex_through] == NO_ROUTE) {
+						continue;
+					}
+					// копии: в диагональном блоке ячейки могут совпасть с релаксируемой
+					const Weight weight_from = weights_from[vertex_through];
+					const PrevEdgeId prev_edge_from = prev_edges_from[vertex_through];
+					RelaxRow(weights_from + to_begin, prev_edges_from + to_begin,
+						weights_through + to_begin, prev_edges_through + to_begin,
+						weight_from, prev_edge_from, to_end - to_begin);
+				}
 			}
 		}
 
-		void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-			for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-				if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-					for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-						if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-							RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-						}
+		/// @brief Релаксация отрезка строки таблицы через промежуточную вершину (см. min_plus::RelaxRow)
+		static void RelaxRow(Weight* weights_from, PrevEdgeId* prev_edges_from,
+			const Weight* weights_through, const PrevEdgeId* prev_edges_through,
+			Weight weight_from, PrevEdgeId prev_edge_from, size_t count) {
+			if constexpr (USE_MIN_PLUS_KERNEL) {
+				min_plus::RelaxRow(weights_from, prev_edges_from, weights_through, prev_edges_through,
+					weight_from, prev_edge_from, count);
+				return;
+			}
+			for (size_t index = 0; index < count; ++index) {
+				const PrevEdgeId prev_edge_to = prev_edges_through[index];
+				if (prev_edge_to == NO_ROUTE) {
+					continue;
+				}
+				const Weight candidate_weight = weight_from + weights_through[index];
+				if (prev_edges_from[index] == NO_ROUTE || candidate_weight < weights_from[index]) {
+					weights_from[index] = candidate_weight;
+					prev_edges_from[index] = prev_edge_to != NO_EDGE ? prev_edge_to : prev_edge_from;
+				}
+			}
+		}
+
+		/// @brief Расширение таблицы путей до текущего числа вершин графа
+		void ResizeRoutesInternalData(size_t vertex_count) {
+			std::vector<Weight> weights(vertex_count * vertex_count, UNREACHABLE_WEIGHT);
+			std::vector<PrevEdgeId> prev_edges(vertex_count * vertex_count, NO_ROUTE);
+			for (VertexId from = 0; from < vertex_count_; ++from) {
+				std::copy_n(&weights_[GetIndex(from, 0)], vertex_count_, &weights[from * vertex_count]);
+				std::copy_n(&prev_edges_[GetIndex(from, 0)], vertex_count_, &prev_edges[from * vertex_count]);
+			}
+			for (VertexId vertex = vertex_count_; vertex < vertex_count; ++vertex) {
+				weights[vertex * vertex_count + vertex] = ZERO_WEIGHT;
+				prev_edges[vertex * vertex_count + vertex] = NO_EDGE;
+			}
+			weights_ = std::move(weights);
+			prev_edges_ = std::move(prev_edges);
+			vertex_count_ = vertex_count;
+			SetTableData();
+		}
+
+		/// @brief Копирование внешней таблицы путей в собственные массивы перед её изменением
+		void CopyExternalTable() {
+			if (table_storage_ == nullptr) {
+				return;
+			}
+			const size_t cell_count = vertex_count_ * vertex_count_;
+			weights_.assign(weights_data_, weights_data_ + cell_count);
+			prev_edges_.assign(prev_edges_data_, prev_edges_data_ + cell_count);
+			table_storage_.reset();
+			SetTableData();
+		}
+
+		/// @brief Чтение таблицы из собственных массивов
+		void SetTableData() {
+			weights_data_ = weights_.data();
+			prev_edges_data_ = prev_edges_.data();
+		}
+
+		/// @brief Вставка ребра в таблицу путей: все пути, улучшаемые проходом по ребру
+		void InsertEdge(EdgeId edge_id, parallel::ThreadPool& thread_pool) {
+			const auto& edge = graph_.GetEdge(edge_id);
+			if (edge.weight < ZERO_WEIGHT) {
+				throw std::domain_error("Edges' weights should be non-negative");
+			}
+			const size_t block_count = (vertex_count_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			// строки релаксируются независимо: строка конца ребра при этом не меняется,
+			// так как веса неотрицательны
+			thread_pool.ParallelFor(block_count, [this, &edge, edge_id](size_t block) {
+				const Weight* weights_through = &weights_[GetIndex(edge.to, 0)];
+				const PrevEdgeId* prev_edges_through = &prev_edges_[GetIndex(edge.to, 0)];
+				const VertexId from_end = std::min(vertex_count_, (block + 1) * BLOCK_SIZE);
+				for (VertexId vertex_from = block * BLOCK_SIZE; vertex_from < from_end; ++vertex_from) {
+					const size_t index = GetIndex(vertex_from, edge.from);
+					if (prev_edges_[index] == NO_ROUTE) {
+						continue;
 					}
+					RelaxRow(&weights_[GetIndex(vertex_from, 0)], &prev_edges_[GetIndex(vertex_from, 0)],
+						weights_through, prev_edges_through,
+						weights_[index] + edge.weight, static_cast<PrevEdgeId>(edge_id), vertex_count_);
 				}
+			});
+		}
+
+		/// @brief Число потоков пула для таблицы текущего размера
+		/// @details Задач не больше, чем блоков таблицы: для таблицы из одного блока пул не создаёт потоков
+		/// и работа идёт в вызывающем потоке
+		size_t GetPoolThreadCount() const {
+			const size_t block_count = (vertex_count_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			const size_t thread_count = thread_count_ != 0
+				? thread_count_ : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+			return std::max<size_t>(std::min(thread_count, block_count), 1);
+		}
+
+		/// @brief Блочный алгоритм Флойда-Уоршелла
+		void RelaxRoutesInternalData(parallel::ThreadPool& thread_pool) {
+			const size_t block_count = (vertex_count_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			for (size_t block_through = 0; block_through < block_count; ++block_through) {
+				// фаза 1: диагональный блок зависит только от себя
+				RelaxBlock(block_through, block_through, block_through);
+				// фаза 2: блоки строки и столбца диагонального блока
+				thread_pool.ParallelFor(2 * block_count, [this, block_through, block_count](size_t index) {
+					const size_t block = index % block_count;
+					if (block == block_through) {
+						return;
+					}
+					if (index < block_count) {
+						RelaxBlock(block_through, block_through, block);
+					}
+					else {
+						RelaxBlock(block_through, block, block_through);
+					}
+					});
+				// фаза 3: остальные блоки зависят только от блоков строки и столбца
+				thread_pool.ParallelFor(block_count * block_count, [this, block_through, block_count](size_t index) {
+					const size_t block_from = index / block_count;
+					const size_t block_to = index % block_count;
+					if (block_from == block_through || block_to == block_through) {
+						return;
+					}
+					RelaxBlock(block_through, block_from, block_to);
+					});
 			}
 		}
 
 		static constexpr Weight ZERO_WEIGHT{};
 		const Graph& graph_;
-		RoutesInternalData routes_internal_data_;
+		size_t thread_count_;
+		size_t vertex_count_;
+		// число рёбер графа, учтённых в таблице
+		size_t edge_count_;
+		// таблица путей между всеми парами вершин, ячейка (from, to) находится по индексу GetIndex(from, to):
+		// вес кратчайшего пути
+		std::vector<Weight> weights_;
+		// последнее ребро кратчайшего пути (NO_ROUTE, если пути нет)
+		std::vector<PrevEdgeId> prev_edges_;
+		// таблица, по которой отвечают запросы: собственные массивы или внешняя память
+		const Weight* weights_data_ = nullptr;
+		const PrevEdgeId* prev_edges_data_ = nullptr;
+		// владелец внешней таблицы; nullptr, если используются собственные массивы
+		std::shared_ptr<const void> table_storage_;
 	};
 
 	template <typename Weight>
-	Router<Weight>::Router(const Graph& graph)
+	Router<Weight>::Router(const Graph& graph, size_t thread_count)
 		: graph_(graph)
-		, routes_internal_data_(graph.GetVertexCount(),
-			std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+		, thread_count_(thread_count)
+		, vertex_count_(graph.GetVertexCount())
+		, edge_count_(graph.GetEdgeCount())
+		, weights_(vertex_count_ * vertex_count_, UNREACHABLE_WEIGHT)
+		, prev_edges_(vertex_count_ * vertex_count_, NO_ROUTE)
 	{
 		InitializeRoutesInternalData(graph);
 
-		const size_t vertex_count = graph.GetVertexCount();
-		for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-			RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+		parallel::ThreadPool thread_pool(GetPoolThreadCount());
+		RelaxRoutesInternalData(thread_pool);
+		SetTableData();
+	}
+
+	template <typename Weight>
+	Router<Weight>::Router(const Graph& graph, RoutesTable table, std::shared_ptr<const void> storage,
+		size_t thread_count)
+		: graph_(graph)
+		, thread_count_(thread_count)
+		, vertex_count_(graph.GetVertexCount())
+		, edge_count_(graph.GetEdgeCount())
+		, weights_data_(table.weights)
+		, prev_edges_data_(table.prev_edges)
+		, table_storage_(std::move(storage))
+	{
+		CheckEdgeCount(graph);
+		if (table.vertex_count != vertex_count_ || table.edge_count != edge_count_) {
+			throw std::invalid_argument("Routes table doesn't match the graph");
+		}
+		if (vertex_count_ > 0 && (table.weights == nullptr || table.prev_edges == nullptr)) {
+			throw std::invalid_argument("Routes table is empty");
 		}
 	}
 
+	template <typename Weight>
+	typename Router<Weight>::RoutesTable Router<Weight>::GetRoutesTable() const {
+		return { vertex_count_, edge_count_, weights_data_, prev_edges_data_ };
+	}
+
+	template <typename Weight>
+	bool Router<Weight>::Update(const std::vector<EdgeId>& new_edge_ids) {
+		if (new_edge_ids.size() != graph_.GetEdgeCount() || new_edge_ids.size() < edge_count_) {
+			throw std::invalid_argument("Edge renumbering doesn't match the graph");
+		}
+		CheckEdgeCount(graph_);
+		// вставка ребра стоит O(V^2), полный пересчёт - O(V^3): при большом числе новых рёбер выгоднее пересчёт
+		const size_t vertex_count = graph_.GetVertexCount();
+		if ((new_edge_ids.size() - edge_count_) * INCREMENTAL_UPDATE_RATIO > vertex_count) {
+			return false;
+		}
+		CopyExternalTable();
+		// старые рёбра в таблице получают новые id
+		for (PrevEdgeId& prev_edge : prev_edges_) {
+			if (prev_edge != NO_ROUTE && prev_edge != NO_EDGE) {
+				prev_edge = static_cast<PrevEdgeId>(new_edge_ids[prev_edge]);
+			}
+		}
+		ResizeRoutesInternalData(vertex_count);
+
+		parallel::ThreadPool thread_pool(GetPoolThreadCount());
+		for (EdgeId edge_id = edge_count_; edge_id < new_edge_ids.size(); ++edge_id) {
+			InsertEdge(new_edge_ids[edge_id], thread_pool);
+		}
+		edge_count_ = new_edge_ids.size();
+		return true;
+	}
+
 	template <typename Weight>
 	std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
 		VertexId to) const {
-		const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-		if (!route_internal_data) {
+		if (from >= vertex_count_ || to >= vertex_count_) {
+			throw std::out_of_range("Vertex id is out of range");
+		}
+		const size_t index = GetIndex(from, to);
+		if (prev_edges_data_[index] == NO_ROUTE) {
 			return std::nullopt;
 		}
-		const Weight weight = route_internal_data->weight;
+		const Weight weight = weights_data_[index];
 		std::vector<EdgeId> edges;
-		for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-			edge_id;
-			edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+		for (PrevEdgeId edge_id = prev_edges_data_[index];
+			edge_id != NO_EDGE;
+			edge_id = prev_edges_data_[GetIndex(from, graph_.GetEdge(edge_id).from)])
 		{
-			edges.push_back(*edge_id);
+			edges.push_back(edge_id);
 		}
 		std::reverse(edges.begin(), edges.end());
 
 		return RouteInfo{ weight, std::move(edges) };
 	}
 
+	template <typename Weight>
+	std::optional<Weight> Router<Weight>::BuildRouteWeight(VertexId from, VertexId to) const {
+		if (from >= vertex_count_ || to >= vertex_count_) {
+			throw std::out_of_range("Vertex id is out of range");
+		}
+		const size_t index = GetIndex(from, to);
+		if (prev_edges_data_[index] == NO_ROUTE) {
+			return std::nullopt;
+		}
+		return weights_data_[index];
+	}
+
+	template <typename Weight>
+	std::vector<std::vector<std::optional<Weight>>> Router<Weight>::BuildWeightMatrix(
+		const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+		std::vector<std::vector<std::optional<Weight>>> result(sources.size(),
+			std::vector<std::optional<Weight>>(targets.size()));
+		for (size_t i = 0; i < sources.size(); ++i) {
+			for (size_t j = 0; j < targets.size(); ++j) {
+				if (sources[i] >= vertex_count_ || targets[j] >= vertex_count_) {
+					throw std::out_of_range("Vertex id is out of range");
+				}
+				const size_t index = GetIndex(sources[i], targets[j]);
+				if (prev_edges_data_[index] != NO_ROUTE) {
+					result[i][j] = weights_data_[index];
+				}
+			}
+		}
+		return result;
+	}
+
 }  // namespace graph
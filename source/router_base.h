@@ -0,0 +1,83 @@
+#pragma once
+
+#include "graph.h"
+
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace graph {
+	/// @brief статистика поисков по запросу
+	struct SearchStats {
+		// число выполненных поисков пути
+		size_t queries = 0;
+		// суммарное число окончательно просмотренных (settled) вершин
+		size_t settled_vertices = 0;
+	};
+
+	/// @brief Общий интерфейс маршрутизаторов (движков поиска кратчайшего пути)
+	/// @details Вес ребра - скалярная стоимость (например, время); описание рёбер для вывода
+	/// хранится вызывающей стороной отдельно и индексируется id ребра
+	template <typename Weight>
+	class RouterBase {
+		static_assert(std::is_arithmetic_v<Weight>, "Router weight should be an arithmetic type");
+
+	public:
+		struct RouteInfo {
+			Weight weight;
+			std::vector<EdgeId> edges;
+		};
+
+		virtual ~RouterBase() = default;
+
+		/// @brief Поиск кратчайшего пути между вершинами графа
+		/// @param from вершина отправления
+		/// @param to вершина прибытия
+		/// @return вес пути и рёбра, из которых он состоит; std::nullopt, если пути нет
+		virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+		/// @brief Вес кратчайшего пути между вершинами графа без восстановления пути
+		/// @details Реализация по умолчанию строит путь целиком; движки, которым вес доступен дешевле,
+		/// переопределяют её
+		/// @return вес пути; std::nullopt, если пути нет
+		virtual std::optional<Weight> BuildRouteWeight(VertexId from, VertexId to) const {
+			if (auto route = BuildRoute(from, to)) {
+				return route->weight;
+			}
+			return std::nullopt;
+		}
+
+		/// @brief Веса кратчайших путей между всеми парами вершин из двух наборов, без восстановления путей
+		/// @details Реализация по умолчанию ищет каждый путь отдельно; движки переопределяют её
+		/// более эффективным расчётом
+		/// @param sources вершины отправления
+		/// @param targets вершины прибытия
+		/// @return матрица весов [источник][цель]; std::nullopt, если пути нет
+		virtual std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+			const std::vector<VertexId>& targets) const {
+			std::vector<std::vector<std::optional<Weight>>> result(sources.size(),
+				std::vector<std::optional<Weight>>(targets.size()));
+			for (size_t i = 0; i < sources.size(); ++i) {
+				for (size_t j = 0; j < targets.size(); ++j) {
+					if (const auto route = BuildRoute(sources[i], targets[j])) {
+						result[i][j] = route->weight;
+					}
+				}
+			}
+			return result;
+		}
+
+		/// @brief Обновление движка после дополнения графа новыми вершинами и рёбрами и его повторной заморозки
+		/// @details Реализация по умолчанию обновление не поддерживает: движок нужно построить заново
+		/// @param new_edge_ids перенумерация рёбер, которую вернул DirectedWeightedGraph::Freeze
+		/// @return true, если движок обновлён и готов к запросам
+		virtual bool Update([[maybe_unused]] const std::vector<EdgeId>& new_edge_ids) {
+			return false;
+		}
+
+		/// @brief Статистика поисков пути; движки без поиска по запросу возвращают нули
+		virtual SearchStats GetSearchStats() const {
+			return {};
+		}
+	};
+}  // namespace graph
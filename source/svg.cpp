@@ -192,4 +192,8 @@ namespace svg {
 		out << "</svg>"sv;
 	}
 
+	void Document::Clear() {
+		objects_ptrs_.clear();
+	}
+
 } // namespace svg
@@ -268,6 +268,9 @@ namespace svg {
 		/// @brief Выводит в ostream svg-представление документа
 		/// @param out 
 		void Render(std::ostream& out) const;
+
+		/// @brief Удаляет все объекты документа
+		void Clear();
 	};
 
 }  // namespace svg
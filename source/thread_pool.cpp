@@ -0,0 +1,92 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace parallel {
+	ThreadPool::ThreadPool(size_t thread_count) {
+		if (thread_count == 0) {
+			thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		}
+		workers_.reserve(thread_count - 1);
+		for (size_t i = 1; i < thread_count; ++i) {
+			workers_.emplace_back([this] { WorkerLoop(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard lock(mutex_);
+			stop_ = true;
+		}
+		job_ready_.notify_all();
+		for (auto& worker : workers_) {
+			worker.join();
+		}
+	}
+
+	size_t ThreadPool::GetThreadCount() const {
+		return workers_.size() + 1;
+	}
+
+	void ThreadPool::ParallelFor(size_t task_count, const std::function<void(size_t)>& task) {
+		if (workers_.empty() || task_count < 2) {
+			for (size_t index = 0; index < task_count; ++index) {
+				task(index);
+			}
+			return;
+		}
+		{
+			std::lock_guard lock(mutex_);
+			task_ = &task;
+			task_count_ = task_count;
+			next_task_ = 0;
+			busy_workers_ = workers_.size();
+			exception_ = nullptr;
+			++generation_;
+		}
+		job_ready_.notify_all();
+		RunTasks();
+		std::unique_lock lock(mutex_);
+		job_done_.wait(lock, [this] { return busy_workers_ == 0; });
+		task_ = nullptr;
+		if (exception_) {
+			std::rethrow_exception(exception_);
+		}
+	}
+
+	void ThreadPool::RunTasks() {
+		for (size_t index = next_task_++; index < task_count_; index = next_task_++) {
+			try {
+				(*task_)(index);
+			}
+			catch (...) {
+				std::lock_guard lock(mutex_);
+				if (!exception_) {
+					exception_ = std::current_exception();
+				}
+				// оставшиеся задачи не выполняются
+				next_task_ = task_count_;
+			}
+		}
+	}
+
+	void ThreadPool::WorkerLoop() {
+		size_t seen_generation = 0;
+		while (true) {
+			{
+				std::unique_lock lock(mutex_);
+				job_ready_.wait(lock, [this, seen_generation] { return stop_ || generation_ != seen_generation; });
+				if (stop_) {
+					return;
+				}
+				seen_generation = generation_;
+			}
+			RunTasks();
+			{
+				std::lock_guard lock(mutex_);
+				--busy_workers_;
+			}
+			job_done_.notify_one();
+		}
+	}
+}  // namespace parallel
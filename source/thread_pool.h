@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+	/// @brief Пул потоков для параллельного выполнения независимых задач
+	/// @details Потоки создаются один раз и переиспользуются между вызовами ParallelFor,
+	/// вызывающий поток тоже участвует в работе
+	class ThreadPool {
+	public:
+		/// @param thread_count общее число потоков, включая вызывающий; 0 - по числу ядер
+		explicit ThreadPool(size_t thread_count);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/// @brief Общее число потоков, включая вызывающий
+		size_t GetThreadCount() const;
+
+		/// @brief Выполнить task(index) для всех index из [0, task_count) и дождаться завершения
+		/// @details Исключение, выброшенное задачей, пробрасывается в вызывающий поток
+		void ParallelFor(size_t task_count, const std::function<void(size_t)>& task);
+
+	private:
+		/// @brief Выполнение задач текущего задания, пока они не закончатся
+		void RunTasks();
+
+		void WorkerLoop();
+
+		std::vector<std::thread> workers_;
+		std::mutex mutex_;
+		std::condition_variable job_ready_;
+		std::condition_variable job_done_;
+		// текущее задание
+		const std::function<void(size_t)>* task_ = nullptr;
+		size_t task_count_ = 0;
+		std::atomic<size_t> next_task_{ 0 };
+		// номер задания: по его смене рабочие потоки узнают о новой работе
+		size_t generation_ = 0;
+		// число рабочих потоков, ещё не закончивших текущее задание
+		size_t busy_workers_ = 0;
+		std::exception_ptr exception_;
+		bool stop_ = false;
+	};
+}  // namespace parallel
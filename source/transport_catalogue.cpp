@@ -1,60 +1,186 @@
 ﻿#include "transport_catalogue.h"
 
+#include <iterator>
+#include <stdexcept>
+
 
 
 
 const domain::RouteData* TransportCatalogue::AddRoute(domain::RouteData&& parsedBusReq) {
-	domain::RouteData& route = routes_[parsedBusReq.name];
+	CheckMutable();
+	domain::RouteId route_id = static_cast<domain::RouteId>(routes_.size());
+	// маршрут с тем же именем заменяется; ключ индекса ссылается на прежнее имя и удаляется до замены
+	if (const auto it = route_ids_.find(parsedBusReq.name); it != route_ids_.end()) {
+		route_id = it->second;
+		route_ids_.erase(it);
+	}
+	else {
+		routes_.emplace_back(&arena_);
+	}
+	// контейнеры маршрута размещены в арене: присваивание переносит в неё содержимое
+	domain::RouteData& route = routes_[route_id];
 	route = std::move(parsedBusReq);
-	for (auto& stop : route.unique_stops) {
-		stops_[stop->name].routes_.insert(&route);
+	route.id = route_id;
+	route_ids_.emplace(route.name, route_id);
+	for (const domain::StopId stop_id : route.unique_stops) {
+		stops_[stop_id].routes_.insert(&route);
 	}
 	return &route;
 }
 
 const domain::StopDataRoutes* TransportCatalogue::AddStop(domain::StopDataRoutes&& parsedStopReq) {
-	//stops_[parsedStopReq.name] = std::move(parsedStopReq);
-	auto result = stops_.insert({ parsedStopReq.name, std::move(parsedStopReq) });
-	return &(result.first->second);
+	CheckMutable();
+	if (const auto it = stop_ids_.find(parsedStopReq.name); it != stop_ids_.end()) {
+		return &stops_[it->second];
+	}
+	const auto stop_id = static_cast<domain::StopId>(stops_.size());
+	domain::StopDataRoutes& stop = stops_.emplace_back(&arena_);
+	stop = std::move(parsedStopReq);
+	stop.id = stop_id;
+	stop_ids_.emplace(stop.name, stop_id);
+	return &stop;
 }
 
 void TransportCatalogue::AddLengthBetweenStops(std::string_view A_stop_name,
 	std::string_view B_stop_name,
 	int length) {
-	// Задание расстояния от А до B
-	auto& A_stop = stops_[A_stop_name];
-	auto& B_stop = stops_[B_stop_name];
-	A_stop.lengths_to_stops[B_stop.name] = length;
+	CheckMutable();
+	const auto A_it = stop_ids_.find(A_stop_name);
+	const auto B_it = stop_ids_.find(B_stop_name);
+	// расстояния до остановок, которых нет в справочнике, не сохраняются
+	if (A_it == stop_ids_.end() || B_it == stop_ids_.end()) {
+		return;
+	}
+	AddLengthBetweenStops(A_it->second, B_it->second, length);
+}
 
-	// Задание расстояния от B до A (если расстояние задано, значит его перезаписывать не надо)
+void TransportCatalogue::AddLengthBetweenStops(domain::StopId A_stop_id, domain::StopId B_stop_id, int length) {
+	CheckMutable();
+	// Задание расстояния от А до B; расстояние от B до A, если его не задали, берётся из него при поиске
+	road_distances_.Set(A_stop_id, B_stop_id, length);
+}
 
-	if (B_stop.lengths_to_stops.find(A_stop.name) == B_stop.lengths_to_stops.end()) {
-		B_stop.lengths_to_stops[A_stop.name] = length;
-	}
+int TransportCatalogue::GetLengthBetweenStops(domain::StopId A_stop_id, domain::StopId B_stop_id) const {
+	return road_distances_.Get(A_stop_id, B_stop_id);
+}
+
+std::vector<int> TransportCatalogue::GetLengthsBetweenStops(RouteStopsRange stops) const {
+	return road_distances_.GetConsecutive(stops);
 }
 
 const domain::StopDataRoutes* TransportCatalogue::GetStop(std::string_view stop_name) const {
-	if (stops_.find(stop_name) != stops_.end()) {
-		return &stops_.at(stop_name);
+	if (snapshot_) {
+		const auto stop_id = snapshot_->stop_index.Find(stop_name);
+		return stop_id ? &stops_[*stop_id] : nullptr;
+	}
+	if (const auto it = stop_ids_.find(stop_name); it != stop_ids_.end()) {
+		return &stops_[it->second];
 	}
 	return nullptr;
 }
 
+const domain::StopDataRoutes& TransportCatalogue::GetStop(domain::StopId stop_id) const {
+	return stops_[stop_id];
+}
+
 const domain::RouteData* TransportCatalogue::GetRoute(std::string_view route_name) const {
-	if (routes_.find(route_name) != routes_.end()) {
-		return &routes_.at(route_name);
+	if (snapshot_) {
+		const auto route_id = snapshot_->route_index.Find(route_name);
+		return route_id ? &routes_[*route_id] : nullptr;
+	}
+	if (const auto it = route_ids_.find(route_name); it != route_ids_.end()) {
+		return &routes_[it->second];
 	}
 	return nullptr;
 }
 
+const domain::RouteData& TransportCatalogue::GetRoute(domain::RouteId route_id) const {
+	return routes_[route_id];
+}
+
+TransportCatalogue::StopRoutesRange TransportCatalogue::GetBusesByStop(domain::StopId stop_id) const {
+	const Snapshot& snapshot = GetSnapshot();
+	const domain::RouteData* const* routes = snapshot.stop_routes.data();
+	return { routes + snapshot.stop_route_offsets[stop_id], routes + snapshot.stop_route_offsets[stop_id + 1] };
+}
+
+TransportCatalogue::RouteStopsRange TransportCatalogue::GetRouteStops(domain::RouteId route_id) const {
+	const Snapshot& snapshot = GetSnapshot();
+	const domain::StopId* stops = snapshot.route_stops.data();
+	return { stops + snapshot.route_stop_offsets[route_id], stops + snapshot.route_stop_offsets[route_id + 1] };
+}
+
+void TransportCatalogue::Freeze() {
+	if (snapshot_) {
+		throw std::logic_error("Catalogue is already frozen");
+	}
+	auto snapshot = std::make_unique<Snapshot>();
+	// маршруты остановок подряд в порядке id остановок; внутри остановки - в порядке номеров
+	snapshot->stop_route_offsets.reserve(stops_.size() + 1);
+	std::vector<std::string_view> stop_names;
+	stop_names.reserve(stops_.size());
+	for (const auto& stop : stops_) {
+		snapshot->stop_route_offsets.push_back(static_cast<uint32_t>(snapshot->stop_routes.size()));
+		snapshot->stop_routes.insert(snapshot->stop_routes.end(), stop.routes_.begin(), stop.routes_.end());
+		stop_names.push_back(stop.name);
+	}
+	snapshot->stop_route_offsets.push_back(static_cast<uint32_t>(snapshot->stop_routes.size()));
+	// остановки маршрутов подряд в порядке id маршрутов; маршрут ТУДА-ОБРАТНО - с обратным направлением
+	snapshot->route_stop_offsets.reserve(routes_.size() + 1);
+	std::vector<std::string_view> route_names;
+	route_names.reserve(routes_.size());
+	for (const auto& route : routes_) {
+		snapshot->route_stop_offsets.push_back(static_cast<uint32_t>(snapshot->route_stops.size()));
+		for (const domain::StopData* stop : route.stops_) {
+			snapshot->route_stops.push_back(stop->id);
+		}
+		if (route.type == domain::route_marks::TO_AND_BACK && !route.stops_.empty()) {
+			for (auto it = std::next(route.stops_.rbegin()); it != route.stops_.rend(); ++it) {
+				snapshot->route_stops.push_back((*it)->id);
+			}
+		}
+		route_names.push_back(route.name);
+	}
+	snapshot->route_stop_offsets.push_back(static_cast<uint32_t>(snapshot->route_stops.size()));
+	// номер имени в индексе совпадает с id
+	snapshot->stop_index.Build(std::move(stop_names));
+	snapshot->route_index.Build(std::move(route_names));
+	snapshot_ = std::move(snapshot);
+}
+
+void TransportCatalogue::Unfreeze() {
+	snapshot_.reset();
+}
+
+bool TransportCatalogue::IsFrozen() const {
+	return snapshot_ != nullptr;
+}
+
+void TransportCatalogue::CheckMutable() const {
+	if (snapshot_) {
+		throw std::logic_error("Can't change a frozen catalogue");
+	}
+}
+
+const TransportCatalogue::Snapshot& TransportCatalogue::GetSnapshot() const {
+	if (!snapshot_) {
+		throw std::logic_error("Catalogue should be frozen before this query");
+	}
+	return *snapshot_;
+}
+
 size_t TransportCatalogue::GetStopsCount() const {
 	return stops_.size();
 }
 
-const std::unordered_map<std::string_view, domain::RouteData>& TransportCatalogue::GetAllRoutes() const {
+size_t TransportCatalogue::GetRoutesCount() const {
+	return routes_.size();
+}
+
+const std::pmr::deque<domain::RouteData>& TransportCatalogue::GetAllRoutes() const {
 	return routes_;
 }
 
-const std::unordered_map<std::string_view, domain::StopDataRoutes>& TransportCatalogue::GetAllStops() const {
+const std::pmr::deque<domain::StopDataRoutes>& TransportCatalogue::GetAllStops() const {
 	return stops_;
 }
@@ -2,58 +2,179 @@
 #pragma once
 #include "domain.h"
 #include "geo.h"
+#include "perfect_hash_index.h"
+#include "ranges.h"
+#include "road_distance_table.h"
 #include <deque>
 #include <list>
+#include <memory>
+#include <memory_resource>
 #include <unordered_set>
 #include <unordered_map>
 #include <set>
 #include <string>
+#include <vector>
 
 
 /// @brief Транспортный справочник
+/// @details Остановкам и маршрутам при добавлении назначаются плотные id (номера в порядке добавления), по
+/// которым они хранятся; по имени ищется только id. Хранилища - std::deque: доступ по id за O(1), а ссылки
+/// на добавленные остановки и маршруты (и их имена) не меняются при дополнении справочника.
+/// Остановки, маршруты, их имена и контейнеры размещаются в арене справочника: память выделяется крупными
+/// блоками и не освобождается по частям, а возвращается целиком при уничтожении справочника.
+/// После наполнения справочник «замораживается» (Freeze): строится неизменяемый снимок для чтения - маршруты
+/// остановок и остановки маршрутов в плоских массивах, имена в индексах на идеальном хэшировании. Запросы
+/// замороженного справочника обслуживаются снимком; для дополнения справочник «размораживается» (Unfreeze)
 class TransportCatalogue {
+public:
+	/// @brief маршруты, проходящие через остановку, в порядке номеров
+	using StopRoutesRange = ranges::Range<const domain::RouteData* const*>;
+	/// @brief id остановок маршрута в порядке проезда
+	using RouteStopsRange = ranges::Range<const domain::StopId*>;
+
 private:
-	/// @brief автобусные остановки
-	std::unordered_map<std::string_view, domain::StopDataRoutes> stops_;
+	// начальный размер блока арены, байт (следующие блоки растут геометрически)
+	static constexpr size_t ARENA_INITIAL_SIZE = 64 * 1024;
+
+	/// @brief арена справочника; объявлена первой, чтобы освобождаться после размещённых в ней контейнеров
+	std::pmr::monotonic_buffer_resource arena_{ ARENA_INITIAL_SIZE };
+
+	/// @brief автобусные остановки, индексированные id
+	std::pmr::deque<domain::StopDataRoutes> stops_{ &arena_ };
+
+	/// @brief автобусные маршруты, индексированные id
+	std::pmr::deque<domain::RouteData> routes_{ &arena_ };
+
+	/// @brief id остановок по именам
+	std::pmr::unordered_map<std::string_view, domain::StopId> stop_ids_{ &arena_ };
 
-	/// @brief автобусные маршруты
-	std::unordered_map<std::string_view, domain::RouteData> routes_;
+	/// @brief id маршрутов по именам
+	std::pmr::unordered_map<std::string_view, domain::RouteId> route_ids_{ &arena_ };
+
+	/// @brief расстояния по дорогам между остановками
+	domain::RoadDistanceTable road_distances_;
+
+	/// @brief снимок замороженного справочника
+	/// @details Размещается в куче, а не в арене: снимок пересоздаётся после каждого дополнения справочника,
+	/// а арена не освобождает память по частям
+	struct Snapshot {
+		/// @brief маршруты остановки stop_id: stop_routes[stop_route_offsets[stop_id]..stop_route_offsets[stop_id + 1])
+		std::vector<uint32_t> stop_route_offsets;
+		std::vector<const domain::RouteData*> stop_routes;
+		/// @brief остановки маршрута route_id: route_stops[route_stop_offsets[route_id]..route_stop_offsets[route_id + 1])
+		std::vector<uint32_t> route_stop_offsets;
+		std::vector<domain::StopId> route_stops;
+		/// @brief id остановок и маршрутов по именам
+		domain::PerfectHashIndex stop_index;
+		domain::PerfectHashIndex route_index;
+	};
+	std::unique_ptr<const Snapshot> snapshot_;
+
+	/// @brief Проверка перед изменением справочника
+	/// @throws std::logic_error, если справочник заморожен
+	void CheckMutable() const;
+
+	/// @brief Снимок замороженного справочника
+	/// @throws std::logic_error, если справочник не заморожен
+	const Snapshot& GetSnapshot() const;
 public:
+	TransportCatalogue() = default;
+
+	// арена не копируется: копия справочника ссылалась бы на память оригинала
+	TransportCatalogue(const TransportCatalogue&) = delete;
+	TransportCatalogue& operator=(const TransportCatalogue&) = delete;
+
 	/// @brief Добавление маршрутов в каталог
+	/// @details Маршрут копируется в арену справочника. Маршрут с уже известным именем заменяет прежний
+	/// и получает его id
+	/// @throws std::logic_error, если справочник заморожен
 	/// @param parsedBusReq маршрут 
 	/// @return константный указатель на добавленный маршрут
 	const domain::RouteData* AddRoute(domain::RouteData&& parsedBusReq);
 
 	/// @brief Добавление остановки в каталог
+	/// @details Остановка копируется в арену справочника. Остановка с уже известным именем не добавляется
+	/// @throws std::logic_error, если справочник заморожен
 	/// @param parsedStopReq остановка
 	/// /// @return константный указатель на добавленную остановку
 	const domain::StopDataRoutes* AddStop(domain::StopDataRoutes&& parsedStopReq);
 
 	/// @brief Задание реального расстояния между остановками A и B
+	/// @throws std::logic_error, если справочник заморожен
 	/// @param A_stop_name первая остановка (
 	/// @param B_stop_name вторая остановка
 	/// @param length реальное расстояние между остановками
 	void AddLengthBetweenStops(std::string_view A_stop_name, std::string_view B_stop_name, int length);
 
+	/// @brief Задание реального расстояния между остановками A и B по их id
+	void AddLengthBetweenStops(domain::StopId A_stop_id, domain::StopId B_stop_id, int length);
+
+	/// @brief Расстояние по дорогам от остановки A до остановки B
+	/// @details Если расстояние от A до B не задано, используется расстояние от B до A
+	/// @throws std::out_of_range, если не задано ни одно из них
+	int GetLengthBetweenStops(domain::StopId A_stop_id, domain::StopId B_stop_id) const;
+
+	/// @brief Расстояния по дорогам между соседними остановками последовательности (пакетный поиск)
+	/// @param stops id остановок, например маршрута в порядке проезда
+	/// @return lengths[i] - расстояние от stops[i] до stops[i + 1] (по правилу GetLengthBetweenStops)
+	std::vector<int> GetLengthsBetweenStops(RouteStopsRange stops) const;
+
 	/// @brief Запрос автобусной остановки по имени
+	/// @details У замороженного справочника имя ищется в индексе снимка
 	/// @param stop_name имя автобусной остановки
 	/// @return константный указатель на остановку
 	const domain::StopDataRoutes* GetStop(std::string_view stop_name) const;
 
+	/// @brief Запрос автобусной остановки по id
+	/// @param stop_id id автобусной остановки (меньше GetStopsCount())
+	/// @return константная ссылка на остановку
+	const domain::StopDataRoutes& GetStop(domain::StopId stop_id) const;
+
+	/// @brief Запрос маршрутов, проходящих через остановку (из снимка)
+	/// @param stop_id id автобусной остановки (меньше GetStopsCount())
+	/// @return маршруты в порядке номеров
+	/// @throws std::logic_error, если справочник не заморожен
+	StopRoutesRange GetBusesByStop(domain::StopId stop_id) const;
+
 	/// @brief Запрос маршрута по имени
+	/// @details У замороженного справочника имя ищется в индексе снимка
 	/// @param route_name имя маршрута
 	/// @return константный указатель на маршрут
 	const domain::RouteData* GetRoute(std::string_view route_name) const;
 
+	/// @brief Запрос маршрута по id
+	/// @param route_id id маршрута (меньше GetRoutesCount())
+	/// @return константная ссылка на маршрут
+	const domain::RouteData& GetRoute(domain::RouteId route_id) const;
+
+	/// @brief Запрос остановок маршрута в порядке проезда (из снимка)
+	/// @details Маршрут ТУДА-ОБРАТНО включает и обратное направление: число остановок равно stops_count
+	/// @param route_id id маршрута (меньше GetRoutesCount())
+	/// @throws std::logic_error, если справочник не заморожен
+	RouteStopsRange GetRouteStops(domain::RouteId route_id) const;
+
+	/// @brief «Заморозка» справочника: построение снимка для чтения
+	/// @throws std::logic_error, если справочник уже заморожен
+	void Freeze();
+
+	/// @brief «Разморозка» справочника для дополнения (снимок удаляется)
+	void Unfreeze();
+
+	bool IsFrozen() const;
+
 	/// @brief Запрос числа остановок
 	/// @return число остановок
 	size_t GetStopsCount() const;
 
+	/// @brief Запрос числа маршрутов
+	/// @return число маршрутов
+	size_t GetRoutesCount() const;
+
 	/// @brief Запрос всех маршрутов
-	/// @return константная ссылка на хранилище маршрутов
-	const std::unordered_map<std::string_view, domain::RouteData>& GetAllRoutes() const;
+	/// @return константная ссылка на хранилище маршрутов (в порядке id)
+	const std::pmr::deque<domain::RouteData>& GetAllRoutes() const;
 
 	/// @brief Запрос всех остановок
-	/// @return константная ссылка на хранилище остановок
-	const std::unordered_map<std::string_view, domain::StopDataRoutes>& GetAllStops() const;
+	/// @return константная ссылка на хранилище остановок (в порядке id)
+	const std::pmr::deque<domain::StopDataRoutes>& GetAllStops() const;
 };
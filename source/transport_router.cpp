@@ -1,7 +1,165 @@
 #include "transport_router.h"
 #include "router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchy_router.h"
+#include "a_star_router.h"
+#include "component_router.h"
+#include "geo.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numeric>
 #include <stdexcept>
 
+namespace {
+	using FloydWarshallRouter = graph::Router<TransportRouter::Weight>;
+
+	/// @brief Формат файла индекса: заголовок, затем таблицы путей компонент графа в порядке их движков.
+	/// Каждая таблица - заголовок таблицы, V*V весов и V*V id рёбер, дополненные до кратного 8 размера
+	struct RoutesIndexHeader {
+		char magic[8];
+		uint32_t version;
+		// проверка порядка байтов: файл читается только на машине с тем же порядком
+		uint32_t byte_order;
+		uint64_t graph_hash;
+		uint64_t table_count;
+	};
+
+	struct RoutesTableHeader {
+		uint64_t vertex_count;
+		uint64_t edge_count;
+	};
+
+	constexpr char ROUTES_INDEX_MAGIC[8] = { 'T', 'C', 'R', 'O', 'U', 'T', 'E', 'S' };
+	// версия меняется при любом изменении формата файла или содержимого таблиц
+	constexpr uint32_t ROUTES_INDEX_VERSION = 1;
+	constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+	constexpr size_t ROUTES_INDEX_ALIGNMENT = 8;
+
+	// рёбра маршрутов создаются в нескольких потоках, начиная с такого числа новых маршрутов
+	constexpr size_t PARALLEL_ROUTE_COUNT = 64;
+
+	size_t AlignSize(size_t size) {
+		return (size + ROUTES_INDEX_ALIGNMENT - 1) / ROUTES_INDEX_ALIGNMENT * ROUTES_INDEX_ALIGNMENT;
+	}
+
+	/// @brief Хэш FNV-1a 64 бит
+	class ContentHasher {
+	public:
+		void Add(const void* data, size_t size) {
+			const auto* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; ++i) {
+				hash_ = (hash_ ^ bytes[i]) * PRIME;
+			}
+		}
+
+		template <typename Value>
+		void Add(const Value& value) {
+			static_assert(std::is_trivially_copyable_v<Value>, "Only trivially copyable values can be hashed");
+			Add(&value, sizeof(value));
+		}
+
+		uint64_t GetHash() const {
+			return hash_;
+		}
+
+	private:
+		static constexpr uint64_t PRIME = 0x100000001b3ull;
+		uint64_t hash_ = 0xcbf29ce484222325ull;
+	};
+
+	/// @brief Разбор отображённого в память файла индекса
+	/// @return таблицы путей, указывающие в память файла; std::nullopt, если файл другой версии, построен
+	/// по другому графу или повреждён
+	std::optional<std::vector<FloydWarshallRouter::RoutesTable>> ParseRoutesIndex(const storage::MappedFile& file,
+		uint64_t graph_hash) {
+		const char* data = file.GetData();
+		const size_t size = file.GetSize();
+		RoutesIndexHeader header{};
+		if (size < sizeof(header)) {
+			return std::nullopt;
+		}
+		std::memcpy(&header, data, sizeof(header));
+		if (std::memcmp(header.magic, ROUTES_INDEX_MAGIC, sizeof(header.magic)) != 0
+			|| header.version != ROUTES_INDEX_VERSION || header.byte_order != BYTE_ORDER_MARK
+			|| header.graph_hash != graph_hash) {
+			return std::nullopt;
+		}
+		std::vector<FloydWarshallRouter::RoutesTable> tables;
+		size_t offset = AlignSize(sizeof(header));
+		for (uint64_t table = 0; table < header.table_count; ++table) {
+			RoutesTableHeader table_header{};
+			if (size < offset + sizeof(table_header)) {
+				return std::nullopt;
+			}
+			std::memcpy(&table_header, data + offset, sizeof(table_header));
+			offset += AlignSize(sizeof(table_header));
+			const size_t cell_count = table_header.vertex_count * table_header.vertex_count;
+			const size_t weights_size = AlignSize(cell_count * sizeof(TransportRouter::Weight));
+			const size_t prev_edges_size = AlignSize(cell_count * sizeof(FloydWarshallRouter::PrevEdgeId));
+			if (size < offset + weights_size + prev_edges_size) {
+				return std::nullopt;
+			}
+			tables.push_back({ table_header.vertex_count, table_header.edge_count,
+				reinterpret_cast<const TransportRouter::Weight*>(data + offset),
+				reinterpret_cast<const FloydWarshallRouter::PrevEdgeId*>(data + offset + weights_size) });
+			offset += weights_size + prev_edges_size;
+		}
+		if (offset != size) {
+			return std::nullopt;
+		}
+		return tables;
+	}
+
+	/// @brief Запись в поток с дополнением нулями до кратного ROUTES_INDEX_ALIGNMENT размера
+	void WriteAligned(std::ostream& out, const void* data, size_t size) {
+		static constexpr char PADDING[ROUTES_INDEX_ALIGNMENT] = {};
+		out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+		out.write(PADDING, static_cast<std::streamsize>(AlignSize(size) - size));
+	}
+	/// @brief Нижняя оценка времени в пути между вершинами графа: расстояние по прямой, делённое на
+	/// наибольшую скорость «по прямой» среди рёбер графа
+	/// @details Скорость берётся по рёбрам, а не из настроек: длина дороги в справочнике может быть меньше
+	/// расстояния по прямой, и тогда оценка по скорости автобуса перестала бы быть нижней
+	class StraightLineTimeBound {
+	public:
+		StraightLineTimeBound(const graph::DirectedWeightedGraph<double>& graph,
+			std::vector<geo::Coordinates> vertex_coordinates)
+			: vertex_coordinates_(std::move(vertex_coordinates)) {
+			double max_speed = 0.0;
+			for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+				const auto& edge = graph.GetEdge(edge_id);
+				const double distance = geo::ComputeDistance(vertex_coordinates_[edge.from], vertex_coordinates_[edge.to]);
+				if (distance <= 0.0) {
+					continue;
+				}
+				// перемещение за нулевое время: оценка вырождается в ноль
+				if (edge.weight <= 0.0) {
+					max_speed = 0.0;
+					break;
+				}
+				max_speed = std::max(max_speed, distance / edge.weight);
+			}
+			inverse_speed_ = max_speed > 0.0 ? 1.0 / max_speed : 0.0;
+		}
+
+		double operator()(graph::VertexId from, graph::VertexId to) const {
+			// запас покрывает погрешность вычисления расстояния
+			const double distance = geo::ComputeDistance(vertex_coordinates_[from], vertex_coordinates_[to]) - DISTANCE_SLACK;
+			return distance > 0.0 ? distance * inverse_speed_ : 0.0;
+		}
+
+	private:
+		// запас, м
+		static constexpr double DISTANCE_SLACK = 1.0;
+		std::vector<geo::Coordinates> vertex_coordinates_;
+		// величина, обратная скорости, мин/м
+		double inverse_speed_ = 0.0;
+	};
+}  // namespace
+
 namespace items {
 	Bus::Bus(std::string_view bus, int span_count, double time) : bus_(bus), span_count_(span_count), time_(time) {}
 	Wait::Wait(std::string_view stop_name, double time) : stop_name_(stop_name), time_(time) {}
@@ -48,53 +206,305 @@ bool Item::IsWait() const {
 	return std::holds_alternative<items::Wait>(value_);
 }
 
-bool TransportRouter::Weight::operator<(const TransportRouter::Weight& other)const {
-	return time_ < other.time_;
+TransportRouter::TransportRouter(const TransportCatalogue& transport_catalogue) : transport_catalogue_(transport_catalogue) {}
+
+void TransportRouter::Init(const RoutingSettings& routing_settings) {
+	routing_settings_ = routing_settings;
+	bus_wait_time_ = routing_settings.bus_wait_time;
+	// переводим скорость из км/ч -> м/мин
+	bus_velocity_ = routing_settings.bus_velocity * 1000.0 / 60.0;
+	path_cache_.SetCapacity(routing_settings.route_cache_size);
+	graph_uptr_ = std::make_unique<graph::DirectedWeightedGraph<Weight>>();
+	edge_infos_.clear();
+	vertex_coordinates_.clear();
+	vertex_stops_.clear();
+	stop_vertices_.clear();
+	graph_route_count_ = 0;
+	AddCatalogueToGraph();
+	CreateRouter(true);
+	path_tree_cache_.SetCapacity(ComputePathTreeCapacity());
+	dijkstra_router_ = UsesPathTrees() ? std::make_unique<graph::DijkstraRouter<Weight>>(*graph_uptr_) : nullptr;
+}
+
+void TransportRouter::Update() {
+	if (router_uptr_ == nullptr) {
+		throw std::logic_error("ERROR router wasn't initiated");
+	}
+	const size_t old_vertex_count = graph_uptr_->GetVertexCount();
+	const size_t old_edge_count = graph_uptr_->GetEdgeCount();
+	const auto new_edge_ids = AddCatalogueToGraph();
+	if (graph_uptr_->GetVertexCount() == old_vertex_count && graph_uptr_->GetEdgeCount() == old_edge_count) {
+		return;
+	}
+	// деревья построены по старому графу и стали больше: ёмкость пересчитывается под тот же бюджет памяти;
+	// частоты запросов остановок сохраняются
+	path_tree_cache_.Clear();
+	path_tree_cache_.Resize(ComputePathTreeCapacity());
+	if (!router_uptr_->Update(new_edge_ids)) {
+		CreateRouter();
+		path_cache_.Clear();
+		return;
+	}
+	// новые рёбра могут только сократить пути: удаляем из кэша пути, для которых нашёлся более короткий
+	path_cache_.EraseIf([this](uint64_t cache_key, const std::optional<Path>& path) {
+		const graph::VertexId from_id = cache_key >> 32;
+		const graph::VertexId to_id = cache_key & 0xFFFFFFFFu;
+		const auto weight = router_uptr_->BuildWeightMatrix({ from_id }, { to_id })[0][0];
+		return weight && (!path || *weight < path->total_time);
+	});
+}
+
+std::vector<graph::EdgeId> TransportRouter::AddCatalogueToGraph() {
+	// новые остановки и маршруты - с id не меньше числа уже добавленных в граф
+	const size_t stop_count = transport_catalogue_.GetStopsCount();
+	const size_t route_count = transport_catalogue_.GetRoutesCount();
+	// вершины новых остановок, за ними вершины «в автобусе» по одной на каждую позицию новых маршрутов
+	size_t new_vertex_count = stop_count - stop_vertices_.size();
+	for (size_t route_id = graph_route_count_; route_id < route_count; ++route_id) {
+		new_vertex_count += transport_catalogue_.GetRoute(static_cast<domain::RouteId>(route_id)).stops_count;
+	}
+	graph_uptr_->Unfreeze();
+	graph::VertexId first_vertex = graph_uptr_->AddVertices(new_vertex_count);
+	vertex_coordinates_.resize(graph_uptr_->GetVertexCount());
+	vertex_stops_.resize(graph_uptr_->GetVertexCount());
+	// вершины новых остановок
+	for (size_t stop_id = stop_vertices_.size(); stop_id < stop_count; ++stop_id) {
+		const auto& stop_data = transport_catalogue_.GetStop(static_cast<domain::StopId>(stop_id));
+		vertex_coordinates_[first_vertex] = stop_data.coordinates;
+		vertex_stops_[first_vertex] = stop_data.id;
+		stop_vertices_.push_back(first_vertex++);
+	}
+	// вершины и рёбра новых маршрутов занимают заранее вычисленные непересекающиеся диапазоны
+	struct RoutePlacement {
+		const domain::RouteData* route;
+		graph::VertexId first_vertex;
+		graph::EdgeId first_edge;
+	};
+	std::vector<RoutePlacement> placements;
+	size_t new_edge_count = 0;
+	for (; graph_route_count_ < route_count; ++graph_route_count_) {
+		const auto& route = transport_catalogue_.GetRoute(static_cast<domain::RouteId>(graph_route_count_));
+		placements.push_back({ &route, first_vertex, new_edge_count });
+		first_vertex += route.stops_count;
+		new_edge_count += GetRouteEdgeCount(route);
+	}
+	const graph::EdgeId first_edge = graph_uptr_->AddEdges(new_edge_count);
+	edge_infos_.resize(graph_uptr_->GetEdgeCount());
+	// генерируем рёбра графа: маршруты независимы и заполняют только свои диапазоны
+	parallel::ThreadPool thread_pool(placements.size() < PARALLEL_ROUTE_COUNT ? 1 : routing_settings_.thread_count);
+	thread_pool.ParallelFor(placements.size(), [this, &placements, first_edge](size_t index) {
+		const auto& placement = placements[index];
+		AddRouteToGraph(*placement.route, placement.first_vertex, first_edge + placement.first_edge);
+	});
+	// упаковываем граф в CSR-представление и переставляем описания рёбер под новые id
+	auto new_edge_ids = graph_uptr_->Freeze();
+	std::vector<EdgeInfo> edge_infos(edge_infos_.size());
+	for (graph::EdgeId edge_id = 0; edge_id < edge_infos_.size(); ++edge_id) {
+		edge_infos[new_edge_ids[edge_id]] = edge_infos_[edge_id];
+	}
+	edge_infos_ = std::move(edge_infos);
+	return new_edge_ids;
 }
 
-bool TransportRouter::Weight::operator>(const TransportRouter::Weight& other)const {
-	return time_ > other.time_;
+void TransportRouter::CreateRouter(bool use_index_file) {
+	using Graph = graph::DirectedWeightedGraph<Weight>;
+	// движок компоненты графа выбирается по настройкам
+	auto router_factory = [this](const Graph& graph,
+		const std::vector<graph::VertexId>& vertices) -> std::unique_ptr<graph::RouterBase<Weight>> {
+		switch (routing_settings_.router_type) {
+		case RouterType::DIJKSTRA:
+			return std::make_unique<graph::DijkstraRouter<Weight>>(graph);
+		case RouterType::CONTRACTION_HIERARCHY:
+			return std::make_unique<graph::ContractionHierarchyRouter<Weight>>(graph);
+		case RouterType::A_STAR:
+		case RouterType::BIDIRECTIONAL_A_STAR: {
+			std::vector<geo::Coordinates> coordinates;
+			coordinates.reserve(vertices.size());
+			for (const graph::VertexId vertex : vertices) {
+				coordinates.push_back(vertex_coordinates_[vertex]);
+			}
+			return std::make_unique<graph::AStarRouter<Weight, StraightLineTimeBound>>(graph,
+				StraightLineTimeBound(graph, std::move(coordinates)),
+				routing_settings_.router_type == RouterType::BIDIRECTIONAL_A_STAR);
+		}
+		case RouterType::HUB_LABELS:
+			return std::make_unique<graph::HubLabelRouter<Weight>>(graph, routing_settings_.thread_count);
+		case RouterType::FLOYD_WARSHALL:
+		default:
+			return std::make_unique<graph::Router<Weight>>(graph, routing_settings_.thread_count);
+		}
+	};
+	// таблицы компонент из файла индекса выдаются движкам по порядку; файл остаётся отображённым в память,
+	// пока таблицы используются
+	struct IndexTables {
+		std::shared_ptr<const storage::MappedFile> file;
+		std::vector<FloydWarshallRouter::RoutesTable> tables;
+		size_t next_table = 0;
+		bool matched = true;
+	};
+	const bool use_index = use_index_file && routing_settings_.router_type == RouterType::FLOYD_WARSHALL
+		&& !routing_settings_.index_file.empty();
+	const uint64_t graph_hash = use_index ? ComputeGraphHash() : 0;
+	auto index_tables = std::make_shared<IndexTables>();
+	if (use_index) {
+		try {
+			index_tables->file = std::make_shared<const storage::MappedFile>(routing_settings_.index_file);
+			if (auto parsed_tables = ParseRoutesIndex(*index_tables->file, graph_hash)) {
+				index_tables->tables = std::move(*parsed_tables);
+			}
+		}
+		// файла ещё нет или его не удалось прочитать: таблицы рассчитываются заново
+		catch (const std::runtime_error&) {
+		}
+	}
+	// фабрика остаётся у ComponentRouter и вызывается и при обновлении графа (Update),
+	// поэтому всё её состояние захватывается по значению
+	auto indexed_router_factory = [this, router_factory, index_tables](
+		const Graph& graph, const std::vector<graph::VertexId>& vertices) -> std::unique_ptr<graph::RouterBase<Weight>> {
+		if (index_tables->next_table < index_tables->tables.size()) {
+			const auto& table = index_tables->tables[index_tables->next_table++];
+			if (table.vertex_count == graph.GetVertexCount() && table.edge_count == graph.GetEdgeCount()) {
+				return std::make_unique<FloydWarshallRouter>(graph, table, index_tables->file, routing_settings_.thread_count);
+			}
+		}
+		index_tables->matched = false;
+		return router_factory(graph, vertices);
+	};
+	// движок строится отдельно для каждой компоненты связности графа (графа ядра, если цепочки сжимаются)
+	auto component_router_factory = [this, &indexed_router_factory](const Graph& graph,
+		const std::vector<graph::VertexId>& vertices) -> std::unique_ptr<graph::RouterBase<Weight>> {
+		// граф ядра перенумерован, и его вершины (член ChainContractionRouter) живут дольше движка компонент;
+		// у графа справочника id вершин - исходные, а сам он при обновлении дополняется новыми вершинами
+		const std::vector<graph::VertexId>* original_ids = &graph == graph_uptr_.get() ? nullptr : &vertices;
+		auto component_router = std::make_unique<graph::ComponentRouter<Weight>>(graph, [indexed_router_factory, original_ids](
+			const Graph& component_graph, const std::vector<graph::VertexId>& component_vertices) {
+			if (original_ids == nullptr) {
+				return indexed_router_factory(component_graph, component_vertices);
+			}
+			// id вершин компоненты переводятся в id исходного графа (нужны, например, координаты для A*)
+			std::vector<graph::VertexId> original_vertices;
+			original_vertices.reserve(component_vertices.size());
+			for (const graph::VertexId vertex : component_vertices) {
+				original_vertices.push_back((*original_ids)[vertex]);
+			}
+			return indexed_router_factory(component_graph, original_vertices);
+		});
+		component_router_ = component_router.get();
+		return component_router;
+	};
+	if (routing_settings_.contract_chains) {
+		auto chain_router = std::make_unique<graph::ChainContractionRouter<Weight>>(*graph_uptr_, component_router_factory);
+		chain_router_ = chain_router.get();
+		router_uptr_ = std::move(chain_router);
+	}
+	else {
+		std::vector<graph::VertexId> vertices(graph_uptr_->GetVertexCount());
+		std::iota(vertices.begin(), vertices.end(), 0);
+		chain_router_ = nullptr;
+		router_uptr_ = component_router_factory(*graph_uptr_, vertices);
+	}
+	if (use_index && (!index_tables->matched || index_tables->next_table != index_tables->tables.size())) {
+		SaveRoutesIndex(graph_hash);
+	}
+	// движки, построенные при обновлении графа, рассчитываются заново
+	index_tables->tables.clear();
+	index_tables->file.reset();
 }
 
-TransportRouter::Weight operator+(const TransportRouter::Weight& lhs, const TransportRouter::Weight& rhs) {
-	TransportRouter::Weight result;
-	// пересели на новый маршрут
-	result.bus_name_ = rhs.bus_name_;
-	// маршруту проедем заданное число остановок
-	result.stops_count_ = rhs.stops_count_;
-	// остановка пересадки
-	result.stop_name_ = rhs.stop_name_;
-	// суммарное время в пути
-	result.time_ = lhs.time_ + rhs.time_;
-	return result;
+uint64_t TransportRouter::ComputeGraphHash() const {
+	ContentHasher hasher;
+	hasher.Add(ROUTES_INDEX_VERSION);
+	hasher.Add(static_cast<uint64_t>(graph_uptr_->GetVertexCount()));
+	hasher.Add(static_cast<uint64_t>(graph_uptr_->GetEdgeCount()));
+	// таблицы сжатого графа строятся по графу ядра
+	hasher.Add(static_cast<uint64_t>(routing_settings_.contract_chains));
+	for (graph::EdgeId edge_id = 0; edge_id < graph_uptr_->GetEdgeCount(); ++edge_id) {
+		const auto& edge = graph_uptr_->GetEdge(edge_id);
+		hasher.Add(static_cast<uint64_t>(edge.from));
+		hasher.Add(static_cast<uint64_t>(edge.to));
+		hasher.Add(edge.weight);
+	}
+	return hasher.GetHash();
 }
 
+void TransportRouter::SaveRoutesIndex(uint64_t graph_hash) const {
+	const auto routers = component_router_->GetComponentRouters();
+	const std::string temp_path = routing_settings_.index_file + ".tmp";
+	{
+		std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			return;
+		}
+		RoutesIndexHeader header{};
+		std::memcpy(header.magic, ROUTES_INDEX_MAGIC, sizeof(header.magic));
+		header.version = ROUTES_INDEX_VERSION;
+		header.byte_order = BYTE_ORDER_MARK;
+		header.graph_hash = graph_hash;
+		header.table_count = routers.size();
+		WriteAligned(out, &header, sizeof(header));
+		for (const auto* router : routers) {
+			const auto table = static_cast<const FloydWarshallRouter*>(router)->GetRoutesTable();
+			const RoutesTableHeader table_header{ table.vertex_count, table.edge_count };
+			const size_t cell_count = table.vertex_count * table.vertex_count;
+			WriteAligned(out, &table_header, sizeof(table_header));
+			WriteAligned(out, table.weights, cell_count * sizeof(Weight));
+			WriteAligned(out, table.prev_edges, cell_count * sizeof(FloydWarshallRouter::PrevEdgeId));
+		}
+		if (!out.flush()) {
+			out.close();
+			std::remove(temp_path.c_str());
+			return;
+		}
+	}
+	// rename не заменяет существующий файл в Windows
+	if (std::rename(temp_path.c_str(), routing_settings_.index_file.c_str()) != 0) {
+		std::remove(routing_settings_.index_file.c_str());
+		if (std::rename(temp_path.c_str(), routing_settings_.index_file.c_str()) != 0) {
+			std::remove(temp_path.c_str());
+		}
+	}
+}
 
-TransportRouter::TransportRouter(const TransportCatalogue& transport_catalogue) : transport_catalogue_(transport_catalogue) {}
+size_t TransportRouter::GetRouteEdgeCount(const domain::RouteData& route) {
+	// посадка, высадка и проезд на каждый перегон
+	return route.stops_count > 0 ? 3 * (route.stops_count - 1) : 0;
+}
 
-void TransportRouter::Init(double bus_wait_time, double bus_velocity) {
-	bus_wait_time_ = bus_wait_time;
-	// переводим скорость из км/ч -> м/мин
-	bus_velocity_ = bus_velocity * 1000.0 / 60.0;
-	graph_uptr_ = std::make_unique<graph::DirectedWeightedGraph<Weight>>(transport_catalogue_.GetStopsCount());
-	id_to_stop_name_.reserve(transport_catalogue_.GetStopsCount());
-	auto all_stops = transport_catalogue_.GetAllStops();
-	// генерируем id остановок и переводчики к ним
-	for (const auto& [stop_name, stop_data] : all_stops) {
-		stop_name_to_id_[stop_name] = id_to_stop_name_.size();
-		id_to_stop_name_.push_back(stop_name);
+void TransportRouter::AddRouteToGraph(const domain::RouteData& route, graph::VertexId first_vertex,
+	graph::EdgeId first_edge) {
+	// полная последовательность остановок из снимка справочника; маршрут ТУДА-ОБРАТНО проходится и в обратном направлении
+	const auto route_stops = transport_catalogue_.GetRouteStops(route.id);
+	const domain::StopId* stops = route_stops.begin();
+	const auto stop_count = static_cast<size_t>(route_stops.end() - route_stops.begin());
+	// вершины и рёбра маршрута выделены по числу его остановок
+	if (stop_count != route.stops_count) {
+		throw std::logic_error("Route " + std::string(route.name) + " doesn't match its stop count");
 	}
-	// генерируем рёбра графа
-	auto all_routes = transport_catalogue_.GetAllRoutes();
-	for (const auto& [route_name, route] : all_routes) {
-		auto edges_count_to_add = AddRouteToGraph(route.stops_.begin(), route.stops_.end(), route_name);
-		// если маршрут туда и обратно, то нужно её ещё его и в обратном направлении добавить в граф
-		if (route.type == domain::route_marks::TO_AND_BACK) {
-			AddRouteToGraph(route.stops_.rbegin(), route.stops_.rend(), route_name, edges_count_to_add);
+	// расстояния по дорогам между соседними остановками запрашиваются одним пакетом
+	const std::vector<int> lengths = transport_catalogue_.GetLengthsBetweenStops(route_stops);
+	graph::EdgeId edge_id = first_edge;
+	for (size_t i = 0; i < stop_count; ++i) {
+		const graph::VertexId stop_vertex = stop_vertices_[stops[i]];
+		const graph::VertexId bus_vertex = first_vertex + i;
+		vertex_coordinates_[bus_vertex] = vertex_coordinates_[stop_vertex];
+		vertex_stops_[bus_vertex] = stops[i];
+		// посадка: ожидание автобуса на остановке
+		if (i + 1 < stop_count) {
+			graph_uptr_->SetEdge(edge_id, { stop_vertex, bus_vertex, bus_wait_time_ });
+			edge_infos_[edge_id++] = { route.id, stops[i], 0, EdgeKind::BOARD };
+		}
+		// высадка на остановке
+		if (i > 0) {
+			graph_uptr_->SetEdge(edge_id, { bus_vertex, stop_vertex, 0.0 });
+			edge_infos_[edge_id++] = { route.id, stops[i], 0, EdgeKind::ALIGHT };
+		}
+		// проезд до следующей остановки маршрута
+		if (i + 1 < stop_count) {
+			const auto time = static_cast<double>(lengths[i]) / bus_velocity_;
+			graph_uptr_->SetEdge(edge_id, { bus_vertex, bus_vertex + 1, time });
+			edge_infos_[edge_id++] = { route.id, stops[i], 1, EdgeKind::RIDE };
 		}
 	}
-	// передаем в маршрутизатор граф
-	router_uptr_ = std::make_unique<graph::Router<Weight>>(*graph_uptr_);
 }
 
 std::optional<TransportRouter::Path> TransportRouter::FindPath(const std::string& from, const std::string& to) const {
@@ -102,19 +512,201 @@ std::optional<TransportRouter::Path> TransportRouter::FindPath(const std::string
 		throw std::logic_error("ERROR router wasn't initiated");
 	}
 
-	auto graph_result = router_uptr_->BuildRoute(stop_name_to_id_.at(from), stop_name_to_id_.at(to));
+	const auto from_id = FindStopVertex(from);
+	const auto to_id = FindStopVertex(to);
+	// остановки нет в этой версии справочника (например, она добавлена обновлением, которое ещё строится)
+	if (!from_id || !to_id) {
+		return std::nullopt;
+	}
+	const uint64_t cache_key = (static_cast<uint64_t>(*from_id) << 32) | static_cast<uint64_t>(*to_id);
+	if (auto cached_path = path_cache_.Get(cache_key)) {
+		return *cached_path;
+	}
+	auto path = BuildPath(*from_id, *to_id);
+	path_cache_.Put(cache_key, path);
+	return path;
+}
+
+std::optional<double> TransportRouter::FindTime(const std::string& from, const std::string& to) const {
+	if (router_uptr_ == nullptr) {
+		throw std::logic_error("ERROR router wasn't initiated");
+	}
+	const auto from_id = FindStopVertex(from);
+	const auto to_id = FindStopVertex(to);
+	// остановки нет в этой версии справочника (например, она добавлена обновлением, которое ещё строится)
+	if (!from_id || !to_id) {
+		return std::nullopt;
+	}
+	if (const auto tree = GetPathTree(*from_id)) {
+		return tree->IsReachable(*to_id) ? std::optional<double>(tree->weights[*to_id]) : std::nullopt;
+	}
+	return router_uptr_->BuildRouteWeight(*from_id, *to_id);
+}
+
+std::optional<TransportRouter::TimeMatrix> TransportRouter::FindTimeMatrix(const std::vector<std::string>& from,
+	const std::vector<std::string>& to) const {
+	if (router_uptr_ == nullptr) {
+		throw std::logic_error("ERROR router wasn't initiated");
+	}
+
+	// перевод названий остановок в вершины графа
+	auto to_vertices = [this](const std::vector<std::string>& stop_names) -> std::optional<std::vector<graph::VertexId>> {
+		std::vector<graph::VertexId> vertices;
+		vertices.reserve(stop_names.size());
+		for (const auto& stop_name : stop_names) {
+			const auto vertex = FindStopVertex(stop_name);
+			if (!vertex) {
+				return std::nullopt;
+			}
+			vertices.push_back(*vertex);
+		}
+		return vertices;
+	};
+	const auto sources = to_vertices(from);
+	const auto targets = to_vertices(to);
+	if (!sources || !targets) {
+		return std::nullopt;
+	}
+	return router_uptr_->BuildWeightMatrix(*sources, *targets);
+}
+
+std::optional<std::vector<TransportRouter::ReachableStop>> TransportRouter::FindReachableStops(const std::string& from,
+	double max_time) const {
+	if (router_uptr_ == nullptr) {
+		throw std::logic_error("ERROR router wasn't initiated");
+	}
+	const auto from_id = FindStopVertex(from);
+	if (!from_id) {
+		return std::nullopt;
+	}
+	std::vector<ReachableStop> stops;
+	// поиск Дейкстры не хранит состояния между запросами и создаётся на месте, если деревья не используются
+	const auto reachable = dijkstra_router_ != nullptr ? dijkstra_router_->FindReachable(*from_id, max_time)
+		: graph::DijkstraRouter<Weight>(*graph_uptr_).FindReachable(*from_id, max_time);
+	for (const auto& [vertex, time] : reachable) {
+		// вершины «в автобусе» пропускаются: до их остановки путь не длиннее (высадка мгновенна)
+		const domain::StopId stop_id = vertex_stops_[vertex];
+		if (stop_vertices_[stop_id] == vertex) {
+			stops.push_back({ transport_catalogue_.GetStop(stop_id).name, time });
+		}
+	}
+	return stops;
+}
+
+cache::CacheStats TransportRouter::GetPathCacheStats() const {
+	return path_cache_.GetStats();
+}
+
+cache::CacheStats TransportRouter::GetPathTreeCacheStats() const {
+	return path_tree_cache_.GetStats();
+}
+
+graph::SearchStats TransportRouter::GetSearchStats() const {
+	if (router_uptr_ == nullptr) {
+		throw std::logic_error("ERROR router wasn't initiated");
+	}
+	return router_uptr_->GetSearchStats();
+}
+
+std::optional<graph::HubLabelStats> TransportRouter::GetHubLabelStats() const {
+	if (routing_settings_.router_type != RouterType::HUB_LABELS || router_uptr_ == nullptr) {
+		return std::nullopt;
+	}
+	// метки строятся по компонентам связности: статистика суммируется
+	graph::HubLabelStats stats;
+	// при сжатии цепочек метки есть только у вершин ядра
+	stats.vertex_count = chain_router_ != nullptr ? chain_router_->GetCoreVertexCount() : graph_uptr_->GetVertexCount();
+	for (const auto* router : component_router_->GetComponentRouters()) {
+		const auto component_stats = static_cast<const graph::HubLabelRouter<Weight>*>(router)->GetLabelStats();
+		stats.forward_entries += component_stats.forward_entries;
+		stats.backward_entries += component_stats.backward_entries;
+		stats.max_label_size = std::max(stats.max_label_size, component_stats.max_label_size);
+		stats.memory_bytes += component_stats.memory_bytes;
+	}
+	if (stats.vertex_count > 0) {
+		stats.average_label_size = static_cast<double>(stats.forward_entries + stats.backward_entries)
+			/ static_cast<double>(2 * stats.vertex_count);
+	}
+	return stats;
+}
+
+std::optional<graph::VertexId> TransportRouter::FindStopVertex(std::string_view stop_name) const {
+	const auto* stop = transport_catalogue_.GetStop(stop_name);
+	// остановки, добавленной в справочник после построения графа, в нём ещё нет
+	if (stop == nullptr || stop->id >= stop_vertices_.size()) {
+		return std::nullopt;
+	}
+	return stop_vertices_[stop->id];
+}
+
+std::shared_ptr<const TransportRouter::PathTree> TransportRouter::GetPathTree(graph::VertexId from) const {
+	if (dijkstra_router_ == nullptr) {
+		return nullptr;
+	}
+	if (auto tree = path_tree_cache_.Get(from)) {
+		return tree;
+	}
+	if (!path_tree_cache_.ShouldAdmit(from)) {
+		return nullptr;
+	}
+	auto tree = std::make_shared<const PathTree>(dijkstra_router_->BuildShortestPathTree(from));
+	path_tree_cache_.Put(from, tree);
+	return tree;
+}
+
+bool TransportRouter::UsesPathTrees() const {
+	switch (routing_settings_.router_type) {
+	case RouterType::DIJKSTRA:
+	case RouterType::A_STAR:
+	case RouterType::BIDIRECTIONAL_A_STAR:
+	case RouterType::CONTRACTION_HIERARCHY:
+		return true;
+	default:
+		return false;
+	}
+}
+
+size_t TransportRouter::ComputePathTreeCapacity() const {
+	if (!UsesPathTrees()) {
+		return 0;
+	}
+	const size_t tree_size = PathTree::GetMemorySize(graph_uptr_->GetVertexCount());
+	return tree_size == 0 ? 0 : routing_settings_.path_tree_cache_mb * 1024 * 1024 / tree_size;
+}
+
+std::optional<TransportRouter::Path> TransportRouter::BuildPath(graph::VertexId from, graph::VertexId to) const {
+	const auto tree = GetPathTree(from);
+	auto graph_result = tree != nullptr ? dijkstra_router_->BuildRoute(*tree, to) : router_uptr_->BuildRoute(from, to);
 	if (graph_result == std::nullopt) {
 		return std::nullopt;
 	}
 	TransportRouter::Path return_result;
 
-	return_result.total_time = (*graph_result).weight.time_;
+	return_result.total_time = (*graph_result).weight;
 
+	// поездка на текущем автобусе: последовательные рёбра проезда сворачиваются в один элемент
+	std::string_view bus_name;
+	int span_count = 0;
+	double time = 0.0;
 	for (const auto& edge_id : (*graph_result).edges) {
-		auto edge = graph_uptr_->GetEdge(edge_id);
-		return_result.items.emplace_back(items::Wait{ edge.weight.stop_name_, bus_wait_time_ });
-		// -bus_wait_time_ , т.к. мы учли его в ребре графа
-		return_result.items.emplace_back(items::Bus{ edge.weight.bus_name_, edge.weight.stops_count_, edge.weight.time_ - bus_wait_time_ });
+		const auto& edge = graph_uptr_->GetEdge(edge_id);
+		const auto& edge_info = edge_infos_[edge_id];
+		// посадка
+		if (edge_info.kind_ == EdgeKind::BOARD) {
+			return_result.items.emplace_back(items::Wait{ transport_catalogue_.GetStop(edge_info.stop_id_).name, edge.weight });
+			bus_name = transport_catalogue_.GetRoute(edge_info.route_id_).name;
+			span_count = 0;
+			time = 0.0;
+		}
+		// высадка
+		else if (edge_info.kind_ == EdgeKind::ALIGHT) {
+			return_result.items.emplace_back(items::Bus{ bus_name, span_count, time });
+		}
+		// проезд
+		else {
+			span_count += edge_info.stops_count_;
+			time += edge.weight;
+		}
 	}
 	return return_result;
 }
@@ -1,8 +1,15 @@
 #pragma once
 #include "graph.h"
-#include "router.h"
+#include "router_base.h"
+#include "hub_label_router.h"
+#include "dijkstra_router.h"
+#include "component_router.h"
+#include "chain_contraction_router.h"
 #include "domain.h"
 #include "transport_catalogue.h" // переход на request
+#include "lru_cache.h"
+#include "lfu_cache.h"
+#include <cstdint>
 #include <set>
 #include <string>
 #include <variant>
@@ -57,20 +64,66 @@ private:
 /// @brief Генератор пути по автобусным маршрутам
 class TransportRouter {
 public:
-	// вес ребра графа
-	struct Weight {
-		// время в пути
-		double time_ = 0.0;
-		// название маршрута
-		std::string_view bus_name_ = "kek";
-		// название остановки отправления
-		std::string_view stop_name_ = "kek";
-		// число посещенных остановок
-		int stops_count_ = 1;
-
-		bool operator<(const Weight& other) const;
-
-		bool operator>(const Weight& other) const;
+	// вес ребра графа: время в пути, мин
+	using Weight = double;
+
+	/// @brief Вид ребра графа
+	enum class EdgeKind {
+		// посадка: из вершины остановки в вершину «в автобусе»
+		BOARD,
+		// высадка: из вершины «в автобусе» в вершину остановки
+		ALIGHT,
+		// проезд до следующей остановки маршрута
+		RIDE
+	};
+
+	/// @brief Описание ребра графа для вывода найденного пути (хранится отдельно от веса)
+	struct EdgeInfo {
+		// id маршрута в справочнике
+		domain::RouteId route_id_ = 0;
+		// id остановки, у которой начинается ребро
+		domain::StopId stop_id_ = 0;
+		// число проеханных перегонов между остановками (1 у ребра проезда, 0 у рёбер посадки и высадки)
+		int stops_count_ = 0;
+		EdgeKind kind_ = EdgeKind::RIDE;
+	};
+
+	/// @brief Алгоритм поиска пути
+	enum class RouterType {
+		// пути между всеми парами остановок рассчитываются при инициализации (Флойд-Уоршелл)
+		FLOYD_WARSHALL,
+		// путь ищется по запросу (Дейкстра)
+		DIJKSTRA,
+		// путь ищется по запросу в заранее построенной иерархии сжатия
+		CONTRACTION_HIERARCHY,
+		// путь ищется по запросу поиском A* с оценкой по расстоянию по прямой
+		A_STAR,
+		// то же, двунаправленным поиском A*
+		BIDIRECTIONAL_A_STAR,
+		// время в пути находится слиянием заранее построенных меток хабов
+		HUB_LABELS
+	};
+
+	/// @brief Настройки генератора путей
+	struct RoutingSettings {
+		// время ожидания автобуса, мин
+		double bus_wait_time = 0.0;
+		// скорость автобуса, км/ч
+		double bus_velocity = 0.0;
+		// алгоритм поиска пути
+		RouterType router_type = RouterType::FLOYD_WARSHALL;
+		// число потоков для предварительного расчёта путей и построения меток (0 - по числу ядер)
+		size_t thread_count = 0;
+		// число найденных путей, хранимых в кэше (0 - кэш отключён)
+		size_t route_cache_size = 0;
+		// файл индекса: таблица путей Флойда-Уоршелла сохраняется в него после расчёта и при следующем
+		// запуске с тем же графом отображается в память вместо пересчёта (пустая строка - не используется)
+		std::string index_file;
+		// память под кэш деревьев кратчайших путей из часто запрашиваемых остановок, МБ (0 - кэш отключён)
+		size_t path_tree_cache_mb = 0;
+		// сжатие проходных остановок и позиций маршрутов в составные рёбра: движок строится по меньшему
+		// графу ядра
+		bool contract_chains = false;
 	};
 private:
 	// трнаспортный каталог
@@ -79,14 +132,28 @@ private:
 	double bus_wait_time_ = 0.0;
 	// скорость автобуса
 	double bus_velocity_ = 0.0;
-	// перевод id остановки в имя
-	std::vector<std::string_view> id_to_stop_name_;
-	// перевод имени остановки в её id
-	std::unordered_map<std::string_view, size_t> stop_name_to_id_;
+	// настройки, с которыми строится маршрутизатор
+	RoutingSettings routing_settings_;
+	// id остановки вершины графа (у вершины «в автобусе» - id её остановки)
+	std::vector<domain::StopId> vertex_stops_;
+	// вершины остановок, индексированные id остановки; остановки с id от размера массива ещё не добавлены в граф
+	std::vector<graph::VertexId> stop_vertices_;
+	// число маршрутов, уже добавленных в граф: маршруты с меньшими id
+	size_t graph_route_count_ = 0;
 	// умный указатель на граф с маршрутами
 	std::unique_ptr<graph::DirectedWeightedGraph<Weight>> graph_uptr_;
+	// описания рёбер графа, индексированные id ребра
+	std::vector<EdgeInfo> edge_infos_;
+	// координаты вершин графа (у вершины «в автобусе» - координаты её остановки)
+	std::vector<geo::Coordinates> vertex_coordinates_;
 	// умный указатель на маршрутизатор
-	std::unique_ptr<graph::Router<Weight>> router_uptr_;
+	std::unique_ptr<graph::RouterBase<Weight>> router_uptr_;
+	// движок по компонентам связности внутри router_uptr_ (таблицы компонент для файла индекса, метки хабов)
+	const graph::ComponentRouter<Weight>* component_router_ = nullptr;
+	// сжатие цепочек внутри router_uptr_; nullptr, если цепочки не сжимаются
+	const graph::ChainContractionRouter<Weight>* chain_router_ = nullptr;
+	// поиск Дейкстры по всему графу для деревьев кратчайших путей; nullptr, если алгоритм не использует кэш деревьев
+	std::unique_ptr<graph::DijkstraRouter<Weight>> dijkstra_router_;
 
 public:
 	TransportRouter(const TransportCatalogue& transport_catalogue);
@@ -94,57 +161,126 @@ public:
 		std::vector<Item> items;
 		double total_time = 0.0;
 	};
+	// матрица времён в пути [отправление][прибытие]; std::nullopt, если пути нет
+	using TimeMatrix = std::vector<std::vector<std::optional<double>>>;
+	/// @brief остановка, достижимая за ограниченное время
+	struct ReachableStop {
+		std::string_view stop_name;
+		// время в пути до остановки, мин
+		double time = 0.0;
+	};
+
+	/// @brief Инициализация класса (справочник должен быть заморожен)
+	/// @param routing_settings настройки генератора путей
+	void Init(const RoutingSettings& routing_settings);
 
-	/// @brief Инициализация класса
-	/// @param bus_wait_time время ожидания автобуса
-	/// @param bus_velocity скорость автобуса
-	void Init(double bus_wait_time, double bus_velocity);
+	/// @brief Добавление в граф остановок и маршрутов, появившихся в справочнике после Init
+	/// @details Таблица путей Флойда-Уоршелла дополняется без полного пересчёта, из кэша удаляются только
+	/// пути, ставшие короче; маршрутизаторы остальных типов строятся заново, кэш очищается.
+	/// Изменение уже добавленных маршрутов не поддерживается. Справочник должен быть снова заморожен
+	void Update();
 
 	/// @brief Поиск пути в графе
 	/// @param from название остановки отправления
 	/// @param to название остановки прибытия
-	/// @return найденный пути
+	/// @return найденный путь; std::nullopt, если пути нет или какой-либо остановки нет в справочнике
 	std::optional<Path> FindPath(const std::string& from, const std::string& to) const;
 
+	/// @brief Время в пути между остановками без восстановления пути
+	/// @details Движок возвращает только вес пути; кэш путей не используется и не пополняется
+	/// @param from название остановки отправления
+	/// @param to название остановки прибытия
+	/// @return время в пути; std::nullopt, если пути нет или какой-либо остановки нет в справочнике
+	std::optional<double> FindTime(const std::string& from, const std::string& to) const;
+
+	/// @brief Расчёт времён в пути между всеми парами остановок из двух наборов (без восстановления путей)
+	/// @param from названия остановок отправления
+	/// @param to названия остановок прибытия
+	/// @return матрица времён; std::nullopt, если какой-либо остановки нет в справочнике
+	std::optional<TimeMatrix> FindTimeMatrix(const std::vector<std::string>& from, const std::vector<std::string>& to) const;
+
+	/// @brief Остановки, до которых можно доехать не дольше чем за заданное время (изохрона)
+	/// @details Выполняется один поиск из остановки отправления, ограниченный временем в пути
+	/// @param from название остановки отправления
+	/// @param max_time наибольшее время в пути, мин
+	/// @return остановки в порядке возрастания времени в пути, включая саму остановку отправления;
+	/// std::nullopt, если остановки нет в справочнике
+	std::optional<std::vector<ReachableStop>> FindReachableStops(const std::string& from, double max_time) const;
+
+	/// @brief Статистика кэша найденных путей
+	/// @return число попаданий и промахов
+	cache::CacheStats GetPathCacheStats() const;
+
+	/// @brief Статистика кэша деревьев кратчайших путей
+	/// @return число попаданий, промахов и вытеснений
+	cache::CacheStats GetPathTreeCacheStats() const;
+
+	/// @brief Статистика поисков пути по запросу (число поисков и просмотренных вершин)
+	/// @details Позволяет сравнить движки, ищущие путь по запросу; у Флойда-Уоршелла и иерархии сжатия - нули
+	graph::SearchStats GetSearchStats() const;
+
+	/// @brief Статистика размеров меток хабов
+	/// @return std::nullopt, если используется другой алгоритм поиска пути
+	std::optional<graph::HubLabelStats> GetHubLabelStats() const;
+
+private:
 	/// @brief добавление маршрута в граф поиска пути
-	/// @tparam Iterator тип итератора
-	/// @param begin начало интервала
-	/// @param end конец интервала
-	/// @return количество рёбер, которое нужно добавить, если идём в обратном пути
-	template<typename Iterator>
-	size_t AddRouteToGraph(Iterator begin, Iterator end, std::string_view bus_name, size_t edges_count_to_add = 0);
-};
+	/// @details Для каждой позиции остановки в маршруте создаётся вершина «в автобусе»: в неё ведёт ребро
+	/// посадки (ожидание автобуса) из вершины остановки, из неё ведут ребро проезда до следующей позиции
+	/// и ребро высадки в вершину остановки. Вершины и рёбра маршрута заранее добавлены в граф и заполняются
+	/// на своих местах, поэтому маршруты можно добавлять параллельно
+	/// @param route маршрут
+	/// @param first_vertex первая вершина «в автобусе» маршрута (всего их route.stops_count)
+	/// @param first_edge первое ребро маршрута (всего их GetRouteEdgeCount(route))
+	void AddRouteToGraph(const domain::RouteData& route, graph::VertexId first_vertex, graph::EdgeId first_edge);
 
-TransportRouter::Weight operator+(const TransportRouter::Weight& lhs, const TransportRouter::Weight& rhs);
-
-template<typename Iterator>
-size_t TransportRouter::AddRouteToGraph(Iterator begin, Iterator end, std::string_view bus_name, size_t edges_count_to_add) {
-	// Обработка текущего маршрута
-	auto it_prev = begin;
-	// id самой первой остановки
-	size_t id_prev = stop_name_to_id_[(*it_prev)->name];
-	auto it_cur = std::next(begin, 1);
-	// id текущей остановки
-	size_t id_cur = stop_name_to_id_[(*it_cur)->name];
-	for (; it_cur != end; std::advance(it_cur, 1), std::advance(it_prev, 1)) {
-		id_prev = stop_name_to_id_[(*it_prev)->name];
-		id_cur = stop_name_to_id_[(*it_cur)->name];
-		auto length = (*it_prev)->lengths_to_stops.at((*it_cur)->name);
-		auto time = static_cast<double>(length) / (bus_velocity_);
-		Weight weight{ time + bus_wait_time_, bus_name ,(*it_prev)->name };
-		auto edge_id = graph_uptr_->AddEdge({ id_prev, id_cur, weight });
-		// количество рёбер графа, которые нужно добавить
-		auto edges_count_to_update_cur = edges_count_to_add;
-		while (edges_count_to_update_cur) {
-			--edge_id;
-			auto edge = graph_uptr_->GetEdge(edge_id);
-			weight = edge.weight;
-			weight.stops_count_ += 1;
-			weight.time_ += time;
-			graph_uptr_->AddEdge({ edge.from, id_cur, weight });
-			--edges_count_to_update_cur;
-		}
-		++edges_count_to_add;
-	}
-	return edges_count_to_add;
-}
+	/// @brief Число рёбер графа, которые создаёт маршрут
+	static size_t GetRouteEdgeCount(const domain::RouteData& route);
+
+	/// @brief Добавление в граф остановок и маршрутов справочника, которых в нём ещё нет, и заморозка графа
+	/// @return перенумерация рёбер при заморозке (см. DirectedWeightedGraph::Freeze)
+	std::vector<graph::EdgeId> AddCatalogueToGraph();
+
+	/// @brief Построение маршрутизатора по графу в соответствии с настройками
+	/// @param use_index_file использовать файл индекса из настроек (только при инициализации): таблицы путей
+	/// Флойда-Уоршелла берутся из него, если он построен по тому же графу, иначе рассчитываются и сохраняются в него
+	void CreateRouter(bool use_index_file = false);
+
+	/// @brief Хэш содержимого графа и настроек, от которых зависят таблицы путей: по нему проверяется,
+	/// что файл индекса построен по тому же графу
+	uint64_t ComputeGraphHash() const;
+
+	/// @brief Сохранение таблиц путей Флойда-Уоршелла всех компонент графа в файл индекса
+	/// @details Файл записывается во временный и переименовывается, чтобы не оставить его недописанным;
+	/// ошибки записи не прерывают работу - индекс будет рассчитан заново при следующем запуске
+	void SaveRoutesIndex(uint64_t graph_hash) const;
+
+	/// @brief Вершина графа остановки с заданным названием
+	/// @return std::nullopt, если остановки нет в справочнике
+	std::optional<graph::VertexId> FindStopVertex(std::string_view stop_name) const;
+
+	/// @brief Поиск пути между вершинами остановок и сборка элементов пути
+	std::optional<Path> BuildPath(graph::VertexId from, graph::VertexId to) const;
+
+	using PathTree = graph::DijkstraRouter<Weight>::ShortestPathTree;
+
+	/// @brief Дерево кратчайших путей из вершины остановки
+	/// @details Дерево строится полным поиском и кэшируется, если остановка запрашивается достаточно часто
+	/// (см. cache::LfuCache); тогда любой путь из неё восстанавливается за время, пропорциональное его длине
+	/// @return nullptr, если кэш деревьев отключён, не используется алгоритмом или дерево не принято в кэш
+	std::shared_ptr<const PathTree> GetPathTree(graph::VertexId from) const;
+
+	/// @brief Используется ли кэш деревьев выбранным алгоритмом
+	/// @details Деревья ускоряют только алгоритмы, ищущие путь по запросу; таблица Флойда-Уоршелла
+	/// и метки хабов отвечают быстрее, чем строится дерево
+	bool UsesPathTrees() const;
+
+	/// @brief Ёмкость кэша деревьев: число деревьев текущего графа, помещающихся в бюджет памяти;
+	/// 0, если алгоритм не использует кэш деревьев
+	size_t ComputePathTreeCapacity() const;
+
+	// кэш найденных путей, ключ - пара id вершин остановок в графе (from << 32 | to)
+	mutable cache::LruCache<uint64_t, std::optional<Path>> path_cache_;
+	// кэш деревьев кратчайших путей, ключ - id вершины остановки отправления
+	mutable cache::LfuCache<graph::VertexId, PathTree> path_tree_cache_;
+};
@@ -0,0 +1,84 @@
+#include "versioned_request_handler.h"
+
+#include <utility>
+
+namespace request_handler {
+	VersionedRequestHandler::~VersionedRequestHandler() {
+		{
+			std::lock_guard lock(mutex_);
+			stop_ = true;
+		}
+		builds_changed_.notify_all();
+		if (writer_.joinable()) {
+			writer_.join();
+		}
+	}
+
+	std::shared_ptr<const VersionedRequestHandler::Version> VersionedRequestHandler::Acquire() const {
+		return std::atomic_load(&current_);
+	}
+
+	uint64_t VersionedRequestHandler::GetVersionNumber() const {
+		const auto version = Acquire();
+		return version != nullptr ? version->number : 0;
+	}
+
+	uint64_t VersionedRequestHandler::Publish(std::shared_ptr<const RequestHandler> handler) {
+		// прежняя версия освобождается после снятия блокировки, если её не держит ни один читатель
+		std::shared_ptr<const Version> previous;
+		std::lock_guard lock(mutex_);
+		previous = std::atomic_load(&current_);
+		// номер следующей версии вычисляется под блокировкой: публикации не перемежаются
+		const uint64_t number = (previous != nullptr ? previous->number : 0) + 1;
+		std::atomic_store(&current_, std::make_shared<const Version>(Version{ number, std::move(handler) }));
+		return number;
+	}
+
+	std::shared_ptr<const RequestHandler> VersionedRequestHandler::TrackRelease(std::shared_ptr<const RequestHandler> handler,
+		std::shared_ptr<std::atomic<bool>> released) {
+		const RequestHandler* raw_handler = handler.get();
+		// удалитель вызывается после того, как последний владелец уменьшил счётчик ссылок (acq_rel),
+		// поэтому все обращения читателей к обработчику предшествуют записи флага
+		return std::shared_ptr<const RequestHandler>(raw_handler,
+			[handler = std::move(handler), released = std::move(released)](const RequestHandler*) {
+				released->store(true, std::memory_order_release);
+			});
+	}
+
+	std::future<uint64_t> VersionedRequestHandler::BuildNext(Builder builder) {
+		std::future<uint64_t> result;
+		{
+			std::lock_guard lock(mutex_);
+			auto& build = builds_.emplace_back();
+			build.builder = std::move(builder);
+			result = build.result.get_future();
+			if (!writer_.joinable()) {
+				writer_ = std::thread([this] { WriterLoop(); });
+			}
+		}
+		builds_changed_.notify_all();
+		return result;
+	}
+
+	void VersionedRequestHandler::WriterLoop() {
+		std::unique_lock lock(mutex_);
+		while (true) {
+			// при остановке запланированные построения завершаются: они могли быть уже обещаны клиентам
+			builds_changed_.wait(lock, [this] { return stop_ || !builds_.empty(); });
+			if (builds_.empty()) {
+				return;
+			}
+			Build& build = builds_.front();
+			lock.unlock();
+			try {
+				build.result.set_value(Publish(build.builder()));
+			}
+			catch (...) {
+				build.result.set_exception(std::current_exception());
+			}
+			lock.lock();
+			builds_.pop_front();
+			builds_changed_.notify_all();
+		}
+	}
+}  // namespace request_handler
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "request_handler.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace request_handler {
+	/// @brief Версии обработчика запросов (справочник вместе с генератором путей и картой) для обновления
+	/// справочника без остановки запросов
+	/// @details Опубликованная версия неизменяема. Читатель берёт текущую версию (атомарная загрузка
+	/// shared_ptr) и обслуживает запрос целиком ею, даже если тем временем опубликована следующая; версия
+	/// освобождается, когда её отпустит последний читатель. Следующие версии строятся в фоновом потоке
+	/// по очереди и публикуются атомарной заменой указателя: чтение никогда не ждёт построения
+	class VersionedRequestHandler {
+	public:
+		/// @brief опубликованная версия; номер хранится вместе с обработчиком, поэтому читатель
+		/// не увидит номер одной версии с обработчиком другой
+		struct Version {
+			// 1, 2, ...
+			uint64_t number = 0;
+			std::shared_ptr<const RequestHandler> handler;
+		};
+		/// @brief построение обработчика следующей версии (выполняется в фоновом потоке)
+		using Builder = std::function<std::shared_ptr<const RequestHandler>()>;
+
+		VersionedRequestHandler() = default;
+		/// @brief Дожидается построения всех запланированных версий
+		~VersionedRequestHandler();
+
+		VersionedRequestHandler(const VersionedRequestHandler&) = delete;
+		VersionedRequestHandler& operator=(const VersionedRequestHandler&) = delete;
+
+		/// @brief Текущая версия; nullptr, если ещё ничего не опубликовано
+		std::shared_ptr<const Version> Acquire() const;
+
+		/// @brief Номер текущей версии (0 - ничего не опубликовано)
+		uint64_t GetVersionNumber() const;
+
+		/// @brief Публикация готового обработчика следующей версией
+		/// @return номер опубликованной версии
+		uint64_t Publish(std::shared_ptr<const RequestHandler> handler);
+
+		/// @brief Обработчик для публикации, сообщающий об освобождении
+		/// @details Возвращённый указатель разделяет владение handler. Когда отпущена его последняя копия
+		/// (версия заменена следующей и её отпустили все читатели), released становится true с release-семантикой:
+		/// поток, прочитавший true с acquire-семантикой, видит все обращения читателей к обработчику завершёнными
+		/// и может изменять его, если держит собственную ссылку
+		static std::shared_ptr<const RequestHandler> TrackRelease(std::shared_ptr<const RequestHandler> handler,
+			std::shared_ptr<std::atomic<bool>> released);
+
+		/// @brief Запланировать построение и публикацию следующей версии в фоновом потоке
+		/// @details Построения выполняются по одному в порядке вызовов
+		/// @return номер опубликованной версии; если построение выбросило исключение, версия
+		/// не публикуется (запросы обслуживает прежняя), а исключение передаётся через результат
+		std::future<uint64_t> BuildNext(Builder builder);
+
+	private:
+		/// @brief запланированное построение и его результат
+		struct Build {
+			Builder builder;
+			std::promise<uint64_t> result;
+		};
+
+		void WriterLoop();
+
+		// текущая версия; читается и заменяется только через std::atomic_load / std::atomic_store
+		std::shared_ptr<const Version> current_;
+
+		std::mutex mutex_;
+		std::condition_variable builds_changed_;
+		// запланированные построения; текущее остаётся в очереди до публикации
+		std::deque<Build> builds_;
+		bool stop_ = false;
+		// поток построения версий; запускается при первом вызове BuildNext
+		std::thread writer_;
+	};
+}  // namespace request_handler